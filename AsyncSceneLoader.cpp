@@ -0,0 +1,260 @@
+#include "AsyncSceneLoader.h"
+
+#include <chrono>
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Ensures that the object starts with initialized values.  Nothing is loaded until Start(...)
+    is called.
+Parameters: None
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+AsyncSceneLoader::AsyncSceneLoader() :
+    _instanceCopies(false),
+    _cancelRequested(false),
+    _loadDone(false),
+    _loadSucceeded(false)
+{
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Waits for the loader thread (if any) to finish.  Objects that haven't been uploaded yet are
+    thrown away.
+
+    Note: The parser can't be stopped part way through a file, so this can take as long as the
+    rest of the file takes to parse.  The loader thread at least stops queueing objects.
+Parameters: None
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+AsyncSceneLoader::~AsyncSceneLoader()
+{
+    _cancelRequested = true;
+    if (_loadThread.joinable())
+    {
+        _loadThread.join();
+    }
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Starts loading the file on a background thread.
+Parameters:
+    filePath    The path to the .obj file, or to a scene manifest (a ".scene" file).
+    options     Passed on to BlenderLoad::LoadObjStreaming(...) (or to SceneManifest::Load(...)).
+Returns:
+    True if the thread was started, otherwise false (a load was already started).
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool AsyncSceneLoader::Start(const std::string &filePath,
+    const BlenderLoad::LoadOptions &options)
+{
+    if (_loadThread.joinable())
+    {
+        cout << "AsyncSceneLoader: a load was already started" << endl;
+        return false;
+    }
+
+    _instanceCopies = options._instanceCopies;
+    if (SceneManifest::IsManifestPath(filePath))
+    {
+        _loadThread = std::thread(&AsyncSceneLoader::LoadSceneOnThisThread, this, filePath,
+            options);
+    }
+    else
+    {
+        _loadThread = std::thread(&AsyncSceneLoader::LoadOnThisThread, this, filePath, options);
+    }
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Call once per frame on the OpenGL thread.  Uploads queued objects
+    (SharedGeometryBuffer::Add(...)) and puts them into the scene until the time budget runs
+    out.
+
+    Note: At least one object is uploaded per call (if any are waiting) so that loading always
+    makes progress, even if a single object takes longer than the budget.
+
+    Also Note: If LoadOptions::_instanceCopies was set, an object that is a translated copy of
+    one already in the scene becomes an instance of it and isn't uploaded at all.
+
+    Also Also Note: Blender object names are unique, but a name that has already been uploaded gets
+    a ".001"-style suffix (see BlenderLoad::UniqueObjectName(...)) rather than replacing or
+    being merged into the existing object, which is already on the GPU.
+Parameters:
+    geometryBuffer  Where the objects are uploaded to.
+    budgetSeconds   Roughly how much of the frame to spend on uploads.
+    putDataHere     The scene.
+Returns:
+    The number of objects that were uploaded.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+size_t AsyncSceneLoader::UploadPending(SharedGeometryBuffer *geometryBuffer,
+    double budgetSeconds, BlenderLoad::GEOMETRY_DATA_BY_NAME *putDataHere)
+{
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    size_t numUploaded = 0;
+    while (true)
+    {
+        std::pair<std::string, GeometryData> readyObject;
+        {
+            // only hold the lock long enough to take the object off the queue; the loader
+            // thread shouldn't have to wait on an upload
+            std::lock_guard<std::mutex> lock(_readyObjectsMutex);
+            if (_readyObjects.empty())
+            {
+                break;
+            }
+            readyObject = std::move(_readyObjects.front());
+            _readyObjects.pop_front();
+        }
+
+        std::string objectName =
+            BlenderLoad::UniqueObjectName(readyObject.first, *putDataHere);
+        GeometryRegistry::HANDLE handle = putDataHere->Add(objectName);
+        GeometryData &geometryData = putDataHere->Geometry(handle);
+        geometryData = std::move(readyObject.second);
+        if (!(_instanceCopies && _copyFinder.Process(putDataHere, handle)))
+        {
+            geometryBuffer->Add(&geometryData);
+        }
+        numUploaded++;
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+        if (elapsed.count() >= budgetSeconds)
+        {
+            break;
+        }
+    }
+
+    return numUploaded;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Tells whether the whole file has been loaded and uploaded.
+Parameters: None
+Returns:
+    True if the loader thread is done and every object has been uploaded, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool AsyncSceneLoader::IsFinished()
+{
+    if (!_loadDone)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(_readyObjectsMutex);
+    return _readyObjects.empty();
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Tells whether the load went well.  Only meaningful once IsFinished() is true.
+Parameters: None
+Returns:
+    The return value of BlenderLoad::LoadObjStreaming(...).
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool AsyncSceneLoader::Succeeded() const
+{
+    return _loadDone && _loadSucceeded;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Gets the loader's statistics.  Only meaningful once IsFinished() is true.
+Parameters: None
+Returns:
+    A reference to the statistics.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+const BlenderLoad::LoadStatistics &AsyncSceneLoader::Statistics() const
+{
+    return _stats;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Gets how long each file of a scene manifest took.  Only meaningful once IsFinished() is
+    true.
+Parameters: None
+Returns:
+    A reference to the statistics (one per file, in manifest order), or to an empty collection
+    if a single .obj file was loaded.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+const std::vector<SceneManifest::FileStatistics> &AsyncSceneLoader::SceneFileStatistics() const
+{
+    return _sceneFileStats;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    The loader thread's body.  Parses the file and queues each object as soon as it is done.
+Parameters:
+    filePath    The path to the .obj file
+    options     Passed on to BlenderLoad::LoadObjStreaming(...).
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+void AsyncSceneLoader::LoadOnThisThread(const std::string &filePath,
+    const BlenderLoad::LoadOptions &options)
+{
+    BlenderLoad::OBJECT_CALLBACK queueObject =
+        [this](const std::string &objectName, GeometryData *geometryData)
+    {
+        if (_cancelRequested)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(_readyObjectsMutex);
+        _readyObjects.push_back(std::make_pair(objectName, std::move(*geometryData)));
+    };
+
+    _loadSucceeded = BlenderLoad::LoadObjStreaming(filePath, queueObject, options, &_stats);
+    _loadDone = true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    The loader thread's body for a scene manifest.  The files are loaded in parallel (see
+    SceneManifest::Load(...)), and then every object is queued.
+Parameters:
+    manifestPath    The path to the ".scene" file.
+    options         Passed on to SceneManifest::Load(...).
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+void AsyncSceneLoader::LoadSceneOnThisThread(const std::string &manifestPath,
+    const BlenderLoad::LoadOptions &options)
+{
+    std::vector<SceneManifest::Entry> entries;
+    BlenderLoad::GEOMETRY_DATA_BY_NAME sceneGeometry;
+    _loadSucceeded = SceneManifest::Read(manifestPath, &entries);
+    if (_loadSucceeded)
+    {
+        // 0: one file per hardware thread
+        _loadSucceeded = SceneManifest::Load(entries, options, 0, &sceneGeometry,
+            &_sceneFileStats, &_stats);
+    }
+
+    for (GeometryRegistry::HANDLE handle = 0;
+        handle < sceneGeometry.Size() && !_cancelRequested; handle++)
+    {
+        std::lock_guard<std::mutex> lock(_readyObjectsMutex);
+        _readyObjects.push_back(std::make_pair(sceneGeometry.Name(handle),
+            std::move(sceneGeometry.Geometry(handle))));
+    }
+
+    _loadDone = true;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "BlenderLoad.h"
+#include "GeometryData.h"
+#include "SceneManifest.h"
+#include "SharedGeometryBuffer.h"
+#include "TranslatedCopies.h"
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Loads a .obj file on a background thread so that the window can come up and render while
+    the file is still being parsed.  The loader thread hands each finished object (see
+    BlenderLoad::LoadObjStreaming(...)) to a queue, and the thread that owns the OpenGL
+    context pulls objects off of it once a frame, uploads them, and puts them into the scene.
+    Large scenes then show up a piece at a time instead of freezing start-up.
+
+    A scene manifest (see SceneManifest) can be given instead of a single .obj file.  Its files
+    are loaded in parallel, and the objects are queued once all of the files are done.
+
+    Note: Only UploadPending(...) touches OpenGL, so it must be called on the thread that owns
+    the OpenGL context.  Everything else is safe from any thread.
+-----------------------------------------------------------------------------------------------*/
+class AsyncSceneLoader
+{
+public:
+    AsyncSceneLoader();
+    ~AsyncSceneLoader();
+
+    bool Start(const std::string &filePath, const BlenderLoad::LoadOptions &options);
+    size_t UploadPending(SharedGeometryBuffer *geometryBuffer, double budgetSeconds,
+        BlenderLoad::GEOMETRY_DATA_BY_NAME *putDataHere);
+
+    bool IsFinished();
+    bool Succeeded() const;
+    const BlenderLoad::LoadStatistics &Statistics() const;
+    const std::vector<SceneManifest::FileStatistics> &SceneFileStatistics() const;
+
+private:
+    // the background thread has a pointer to this object, so it must stay put
+    AsyncSceneLoader(const AsyncSceneLoader &) = delete;
+    AsyncSceneLoader &operator=(const AsyncSceneLoader &) = delete;
+
+    void LoadOnThisThread(const std::string &filePath, const BlenderLoad::LoadOptions &options);
+    void LoadSceneOnThisThread(const std::string &manifestPath,
+        const BlenderLoad::LoadOptions &options);
+
+    std::thread _loadThread;
+
+    // finished objects that haven't been uploaded yet
+    std::mutex _readyObjectsMutex;
+    std::deque<std::pair<std::string, GeometryData>> _readyObjects;
+
+    // only used by UploadPending(...), on the OpenGL thread (see LoadOptions::_instanceCopies)
+    bool _instanceCopies;
+    TranslatedCopyFinder _copyFinder;
+
+    // set by the destructor so that the loader thread stops queueing objects
+    std::atomic<bool> _cancelRequested;
+
+    // written by the loader thread before _loadDone is set, so they are safe to read after
+    // _loadDone is seen to be true
+    std::atomic<bool> _loadDone;
+    bool _loadSucceeded;
+    BlenderLoad::LoadStatistics _stats;
+
+    // one per file if a scene manifest was loaded, otherwise empty
+    std::vector<SceneManifest::FileStatistics> _sceneFileStats;
+};
@@ -1,241 +1,2825 @@
 #include "BlenderLoad.h"
 
 #include <fstream>
+#include <chrono>
+#include <algorithm>
+#include <thread>
+#include <map>
+
+// for memchr(...) and memcmp(...)
+#include <string.h>
+
+// for snprintf(...)
+#include <stdio.h>
+
+// for fabsf(...)
+#include <math.h>
 
 #include <iostream>
 using std::cout;
 using std::endl;
 
-#include "glload/include/glload/gl_4_4.h"
+#include "glload/include/glload/gl_4_4.h"
+#include "MemoryMappedFile.h"
+#include "DecompressionStream.h"
+#include "FastNumberParse.h"
+#include "GeometryCache.h"
+#include "ProcessMemory.h"
+#include "VertexWeld.h"
+#include "LineStitch.h"
+#include "VertexLayout.h"
+#include "FaceTriangulation.h"
+
+
+// parse it line by line
+// Note: Each line of data is preceded by a 1-char symbol.
+// Also Note: It is possible for a single object to have both an "f" and an "l", but if this
+// has happened, this means that there is a mix of 2D and 3D vertices and something has gone
+// wrong when manipulating the object in Blender.  For the sake of this demo, assume that if
+// the object specifies "f" then it has faces and if it specifies "l" then it has lines.
+// Also Note: These are compared against the raw bytes of each line, so the "- 1" in the
+// lengths cuts off the null terminator.
+static const char LINE_HEADER_OBJECT_NAME[] = "o ";
+static const char LINE_HEADER_VERTEX_POSITION[] = "v ";
+static const char LINE_HEADER_VERTEX_NORMAL[] = "vn ";
+static const char LINE_HEADER_FACE[] = "f ";
+static const char LINE_HEADER_LINE[] = "l ";
+static const char LINE_HEADER_USE_MATERIAL[] = "usemtl ";
+static const char LINE_HEADER_SMOOTH_SHADING[] = "s ";
+static const char LINE_HEADER_COMMENT[] = "#";
+#define LINE_HEADER_LENGTH(header) (sizeof(header) - 1)
+
+// Blender numbers positions and normals across the whole file, so the indices grow with the
+// size of the scene rather than the size of an object
+// Note: 32 bits is enough for 4 billion positions.  Define BLENDER_LOAD_64_BIT_INDICES in the
+// preprocessor settings for anything bigger than that.
+#ifdef BLENDER_LOAD_64_BIT_INDICES
+typedef unsigned long long OBJ_INDEX;
+#else
+typedef unsigned int OBJ_INDEX;
+#endif
+
+// lines are 2 position indices that turn into 2 vertices
+// Note: Faces can have any number of corners (see FaceVertexCount(...)).
+static const size_t INDICES_PER_LINE = 2;
+static const size_t VERTS_PER_LINE = 2;
+
+// splitting a small file across threads costs more than it saves, so each thread gets at least
+// this much text
+static const size_t MIN_BYTES_PER_THREAD = 256 * 1024;
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    What kind of data a single line of the .obj file holds.  Determined by the line header.
+-----------------------------------------------------------------------------------------------*/
+enum ObjLineType
+{
+    OBJ_LINE_OBJECT_NAME = 0,
+    OBJ_LINE_VERTEX_POSITION,
+    OBJ_LINE_VERTEX_NORMAL,
+    OBJ_LINE_LINE,
+    OBJ_LINE_FACE,
+    OBJ_LINE_USE_MATERIAL,
+    OBJ_LINE_SMOOTH_SHADING,
+    OBJ_LINE_COMMENT,
+    OBJ_LINE_UNKNOWN,
+};
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Collections that are reused from one face to the next so that faces of any size can be
+    read and triangulated without allocating for every face.  One per thread.
+-----------------------------------------------------------------------------------------------*/
+struct ObjFaceScratch
+{
+    // position-normal index pairs from ParseFaceIndices(...)
+    std::vector<OBJ_INDEX> _indices;
+
+    std::vector<glm::vec3> _cornerPositions;
+    std::vector<unsigned int> _triangles;
+    FaceTriangulator _triangulator;
+};
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Everything that needs to be carried from one line of the .obj file to the next.
+-----------------------------------------------------------------------------------------------*/
+struct ObjParseState
+{
+    ObjParseState(BlenderLoad::GEOMETRY_DATA_BY_NAME *putDataHere) :
+        _putDataHere(putDataHere),
+        _onObjectLoaded(0),
+        _weldStreamedObjects(false),
+        _streamedWeldStats(0),
+        _streamedQuantizationStats(0),
+        _stitchLines(false),
+        _geometryData(0),
+        _numBadRecords(0),
+        _numRecordsWithoutObject(0),
+        _maxUnknownLineSamples(0),
+        _numVertsEmitted(0),
+        _numStreamedObjects(0),
+        _weldSeconds(0.0),
+        _positionIndexBase(0),
+        _normalIndexBase(0)
+    {
+    }
+
+    ObjParseState(const BlenderLoad::OBJECT_CALLBACK *onObjectLoaded) :
+        _putDataHere(0),
+        _onObjectLoaded(onObjectLoaded),
+        _weldStreamedObjects(false),
+        _streamedWeldStats(0),
+        _streamedQuantizationStats(0),
+        _stitchLines(false),
+        _geometryData(0),
+        _numBadRecords(0),
+        _numRecordsWithoutObject(0),
+        _maxUnknownLineSamples(0),
+        _numVertsEmitted(0),
+        _numStreamedObjects(0),
+        _weldSeconds(0.0),
+        _positionIndexBase(0),
+        _normalIndexBase(0)
+    {
+    }
+
+    std::vector<glm::vec3> _vertPositions;
+    //std::vector<glm::vec3> _vertTextureCoord;    // not supported (yet)
+    std::vector<glm::vec3> _vertNormals;
+
+    // where finished objects go; exactly one of these is not null
+    // Note: Objects are put into the collection as soon as their "o" line is read and are
+    // filled in place.  Objects are only handed to the callback once they are finished (see
+    // FinishStreamedObject(...)).
+    BlenderLoad::GEOMETRY_DATA_BY_NAME *_putDataHere;
+    const BlenderLoad::OBJECT_CALLBACK *_onObjectLoaded;
+
+    // streaming only: the object that is being filled until it is handed to the callback
+    std::string _streamedObjectName;
+    GeometryData _streamedObject;
+    bool _weldStreamedObjects;
+    std::vector<BlenderLoad::WeldStatistics> *_streamedWeldStats;
+    std::vector<BlenderLoad::QuantizationStatistics> *_streamedQuantizationStats;
+
+    // for welding (see LoadOptions::_stitchLines)
+    bool _stitchLines;
+
+    // from the counting pass (see LoadOptions::_preallocate)
+    std::map<std::string, size_t> _expectedVertsByName;
+
+    // the object that faces and lines are currently being jammed into
+    GeometryData *_geometryData;
+
+    // faces and lines that refer to a position or normal that doesn't exist (yet)
+    size_t _numBadRecords;
+
+    // faces and lines before the first "o" line, which are ignored (and reported once)
+    size_t _numRecordsWithoutObject;
+
+    ObjFaceScratch _faceScratch;
+
+    // for LoadStatistics
+    // Note: Only the first _maxUnknownLineSamples unknown lines are kept.  The rest are only
+    // counted.
+    BlenderLoad::LineCounts _lineCounts;
+    size_t _maxUnknownLineSamples;
+    std::vector<std::string> _unknownLineSamples;
+    unsigned long long _numVertsEmitted;
+    size_t _numStreamedObjects;
+    double _weldSeconds;
+
+    // LoadObjSelected(...) only: how many positions and normals in the file come before the
+    // ones in _vertPositions and _vertNormals
+    // Note: These are subtracted from every index in a face or line.
+    OBJ_INDEX _positionIndexBase;
+    OBJ_INDEX _normalIndexBase;
+};
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Checks if the line begins with the provided header without making any substrings.
+Parameters:
+    lineBegin       Pointer to the first character of the line.
+    lineEnd         Pointer to one past the last character of the line.
+    header          The header characters (not necessarily null terminated).
+    headerLength    Self-explanatory.
+Returns:
+    True if the line is at least as long as the header and starts with it, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static bool LineStartsWith(const char *lineBegin, const char *lineEnd, const char *header,
+    size_t headerLength)
+{
+    return (static_cast<size_t>(lineEnd - lineBegin) >= headerLength) &&
+        (memcmp(lineBegin, header, headerLength) == 0);
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Finds the newline that ends the line that starts at lineBegin.
+Parameters:
+    lineBegin   Self-explanatory.
+    textEnd     Pointer to one past the last character of the whole text.
+Returns:
+    A pointer to the '\n' at the end of the line, or textEnd if it is the last line.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static const char *FindLineEnd(const char *lineBegin, const char *textEnd)
+{
+    const void *newline = memchr(lineBegin, '\n', textEnd - lineBegin);
+    return (newline == 0) ? textEnd : static_cast<const char *>(newline);
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Checks if a line contains "OBJ".  Blender writes this in the comment on the first line of
+    the file.
+Parameters:
+    lineBegin   Pointer to the first character of the line.
+    lineEnd     Pointer to one past the last character of the line.
+Returns:
+    True if the tag was found, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static bool LineHasObjTag(const char *lineBegin, const char *lineEnd)
+{
+    static const char objTag[] = "OBJ";
+    return std::search(lineBegin, lineEnd, objTag, objTag + 3) != lineEnd;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Figures out what kind of data is on the line by looking at its header.  Also trims off any
+    '\r' that came along from a file that was saved on Windows and read in binary (as the
+    memory-mapped file is).
+Parameters:
+    lineBegin   Pointer to the first character of the line.
+    lineEnd     Pointer to one past the last character of the line (excluding the '\n').  Moved
+                back by 1 if the line ends in '\r'.
+    argsBegin   Gets a pointer to the first character after the header.
+Returns:
+    See description.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static ObjLineType ClassifyObjLine(const char *lineBegin, const char **lineEnd,
+    const char **argsBegin)
+{
+    if (*lineEnd > lineBegin && *(*lineEnd - 1) == '\r')
+    {
+        (*lineEnd)--;
+    }
+
+    if (*lineEnd == lineBegin)
+    {
+        // blank lines are as good as comments
+        *argsBegin = lineBegin;
+        return OBJ_LINE_COMMENT;
+    }
+
+    struct LineHeader
+    {
+        const char *_header;
+        size_t _length;
+        ObjLineType _type;
+    };
+
+    // Note: Order matters.  "vn " must not be mistaken for "v ", which it is not because of
+    // the space, but keep the original order of checks anyway.
+    static const LineHeader lineHeaders[] =
+    {
+        { LINE_HEADER_OBJECT_NAME, LINE_HEADER_LENGTH(LINE_HEADER_OBJECT_NAME),
+            OBJ_LINE_OBJECT_NAME },
+        { LINE_HEADER_VERTEX_POSITION, LINE_HEADER_LENGTH(LINE_HEADER_VERTEX_POSITION),
+            OBJ_LINE_VERTEX_POSITION },
+        { LINE_HEADER_VERTEX_NORMAL, LINE_HEADER_LENGTH(LINE_HEADER_VERTEX_NORMAL),
+            OBJ_LINE_VERTEX_NORMAL },
+        { LINE_HEADER_LINE, LINE_HEADER_LENGTH(LINE_HEADER_LINE), OBJ_LINE_LINE },
+        { LINE_HEADER_FACE, LINE_HEADER_LENGTH(LINE_HEADER_FACE), OBJ_LINE_FACE },
+        { LINE_HEADER_USE_MATERIAL, LINE_HEADER_LENGTH(LINE_HEADER_USE_MATERIAL),
+            OBJ_LINE_USE_MATERIAL },
+        { LINE_HEADER_SMOOTH_SHADING, LINE_HEADER_LENGTH(LINE_HEADER_SMOOTH_SHADING),
+            OBJ_LINE_SMOOTH_SHADING },
+        { LINE_HEADER_COMMENT, LINE_HEADER_LENGTH(LINE_HEADER_COMMENT), OBJ_LINE_COMMENT },
+    };
+
+    for (size_t headerIndex = 0; headerIndex < sizeof(lineHeaders) / sizeof(lineHeaders[0]);
+        headerIndex++)
+    {
+        const LineHeader &lineHeader = lineHeaders[headerIndex];
+        if (LineStartsWith(lineBegin, *lineEnd, lineHeader._header, lineHeader._length))
+        {
+            *argsBegin = lineBegin + lineHeader._length;
+            return lineHeader._type;
+        }
+    }
+
+    *argsBegin = lineBegin;
+    return OBJ_LINE_UNKNOWN;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Reads the 3 floats of a "v" or "vn" line.
+
+    Note: Missing values are left at 0.
+Parameters:
+    argsBegin   Pointer to the first character after the line header.
+    lineEnd     Pointer to one past the last character of the line.
+Returns:
+    The X, Y, and Z values in a vec3.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static glm::vec3 ParseVec3(const char *argsBegin, const char *lineEnd)
+{
+    glm::vec3 values(0.0f);
+    const char *current = argsBegin;
+    for (int valueIndex = 0; valueIndex < 3 && current != 0; valueIndex++)
+    {
+        current = ParseFloat(current, lineEnd, &values[valueIndex]);
+    }
+    return values;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Reads the 2 position indices of an "l" line.
+Parameters:
+    argsBegin   Pointer to the first character after the line header.
+    lineEnd     Pointer to one past the last character of the line.
+    indices     Gets INDICES_PER_LINE values: p1, p2.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static void ParseLineIndices(const char *argsBegin, const char *lineEnd, OBJ_INDEX *indices)
+{
+    // 2D lines in Blender only have positions, not normals nor texture coordinates
+    OBJ_INDEX p1Index = 0;
+    OBJ_INDEX p2Index = 0;
+
+    const char *current = ParseUnsignedInt(argsBegin, lineEnd, &p1Index);
+    if (current != 0)
+    {
+        ParseUnsignedInt(current, lineEnd, &p2Index);
+    }
+
+    indices[0] = p1Index;
+    indices[1] = p2Index;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Reads the position and normal indices of an "f" line, however many corners it has.
+
+    Note: Each corner is "p/t/n", or "p//n" if there are no texture coordinates.  "p" and
+    "p/t" are handled as well, in which case the normal index stays 0.
+Parameters:
+    argsBegin       Pointer to the first character after the line header.
+    lineEnd         Pointer to one past the last character of the line.
+    putIndicesHere  Gets 2 values per corner added on the end: p1, n1, p2, n2, ...
+Returns:
+    The number of corners.  A corner that can't be read gets a position index of 0 (so the
+    face will be rejected), and nothing after it is read.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static size_t ParseFaceIndices(const char *argsBegin, const char *lineEnd,
+    std::vector<OBJ_INDEX> *putIndicesHere)
+{
+    size_t numCorners = 0;
+    const char *current = argsBegin;
+    while (current != 0)
+    {
+        while (current < lineEnd && (*current == ' ' || *current == '\t'))
+        {
+            current++;
+        }
+        if (current == lineEnd)
+        {
+            break;
+        }
+
+        // 'p' = position, 't' texture coordinate, 'n' = normal
+        // Note: Texture coordinates not available yet, but handling them here anyway.
+        // Also Note: The face indices begin at 1 (not 0), so if the index is 0, then there is
+        // no value.
+        OBJ_INDEX pIndex = 0;
+        OBJ_INDEX tIndex = 0;
+        OBJ_INDEX nIndex = 0;
+        current = ParseUnsignedInt(current, lineEnd, &pIndex);
+        if (current != 0 && current < lineEnd && *current == '/')
+        {
+            current++;
+            if (current < lineEnd && *current != '/')
+            {
+                current = ParseUnsignedInt(current, lineEnd, &tIndex);
+            }
+            if (current != 0 && current < lineEnd && *current == '/')
+            {
+                current = ParseUnsignedInt(current + 1, lineEnd, &nIndex);
+            }
+        }
+
+        putIndicesHere->push_back(pIndex);
+        putIndicesHere->push_back(nIndex);
+        numCorners++;
+    }
+
+    return numCorners;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Counts the corners of an "f" line without reading any numbers (for the counting pass).
+    Each corner is a run of characters with no spaces or tabs in it.
+Parameters:
+    argsBegin   Pointer to the first character after the line header.
+    lineEnd     Pointer to one past the last character of the line.
+Returns:
+    The number of corners.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static size_t CountFaceCorners(const char *argsBegin, const char *lineEnd)
+{
+    size_t numCorners = 0;
+    bool inCorner = false;
+    for (const char *current = argsBegin; current < lineEnd; current++)
+    {
+        bool isSpace = (*current == ' ' || *current == '\t');
+        if (!isSpace && !inCorner)
+        {
+            numCorners++;
+        }
+        inCorner = !isSpace;
+    }
+    return numCorners;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    How many vertices a face turns into.  A face with N corners is always cut into N - 2
+    triangles (see FaceTriangulator).
+Parameters:
+    numCorners  Self-explanatory.
+Returns:
+    3 * (N - 2), or 0 if there are too few corners to make a triangle.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static size_t FaceVertexCount(size_t numCorners)
+{
+    return (numCorners >= 3) ? 3 * (numCorners - 2) : 0;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Checks that a 1-based index from the file refers to an item that exists.  An index of 0
+    means that the value was missing or could not be read.
+Parameters:
+    index       Self-explanatory.
+    numItems    How many positions (or normals) there are.
+Returns:
+    True if the index can be used (after subtracting 1), otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static bool IndexIsValid(OBJ_INDEX index, size_t numItems)
+{
+    return (index != 0) && (index <= numItems);
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Makes a single global 1-based index relative to a base (see RebaseRecordIndices(...)).
+Parameters:
+    index   Self-explanatory.
+    base    How many items come before the first one that was read.
+Returns:
+    The relative index, or 0 if the index points at or before the base.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static OBJ_INDEX RebaseIndex(OBJ_INDEX index, OBJ_INDEX base)
+{
+    return (index > base) ? (index - base) : 0;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Makes the global 1-based indices of a face or line relative to the positions and normals
+    that have actually been read (see ObjParseState::_positionIndexBase).  An index that points
+    at or before the base refers to something that wasn't read, so it is set to 0 and the
+    record will be rejected.
+Parameters:
+    state       Self-explanatory.
+    lineType    OBJ_LINE_LINE or OBJ_LINE_FACE.
+    indices     Self-explanatory.
+    numIndices  INDICES_PER_LINE for a line, or 2 per corner for a face.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static void RebaseRecordIndices(const ObjParseState &state, ObjLineType lineType,
+    OBJ_INDEX *indices, size_t numIndices)
+{
+    if (lineType == OBJ_LINE_LINE)
+    {
+        for (size_t index = 0; index < numIndices; index++)
+        {
+            indices[index] = RebaseIndex(indices[index], state._positionIndexBase);
+        }
+        return;
+    }
+
+    // position-normal pairs
+    for (size_t index = 0; index + 1 < numIndices; index += 2)
+    {
+        indices[index] = RebaseIndex(indices[index], state._positionIndexBase);
+        indices[index + 1] = RebaseIndex(indices[index + 1], state._normalIndexBase);
+    }
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Turns the indices of an "l" line into vertices.
+Parameters:
+    vertPositions   All positions in the file up to (at least) this line.
+    indices         INDICES_PER_LINE values from ParseLineIndices(...).
+    putVertsHere    Must have room for VERTS_PER_LINE vertices.
+Returns:
+    False if an index is out of range (the vertices are not touched), otherwise true.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static bool MakeLineVertices(const std::vector<glm::vec3> &vertPositions,
+    const OBJ_INDEX *indices, MyVertex *putVertsHere)
+{
+    if (!IndexIsValid(indices[0], vertPositions.size()) ||
+        !IndexIsValid(indices[1], vertPositions.size()))
+    {
+        return false;
+    }
+
+    // create the vertex objects and put them into the geometry data
+    // Note: Indices for lines begin at 1 (not 0).
+    // Also Note: +Z is up, and this is 2D, so I only need the X and Y out of the
+    // position, and thus I can jam the vec3 position into a vec2 and the constructor
+    // will cut off the Z.
+    glm::vec2 p1(vertPositions[indices[0] - 1]);
+    glm::vec2 p2(vertPositions[indices[1] - 1]);
+
+    // remember that Blender3D does not specify normals for simple lines, so just stick
+    // in an empty normal.
+    putVertsHere[0] = MyVertex(p1, glm::vec2());
+    putVertsHere[1] = MyVertex(p2, glm::vec2());
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Turns the indices of an "f" line into triangles (see FaceTriangulator).
+Parameters:
+    vertPositions   All positions in the file up to (at least) this line.
+    vertNormals     All normals in the file up to (at least) this line.
+    indices         2 values per corner from ParseFaceIndices(...).
+    numCorners      Self-explanatory.
+    scratch         Reused from face to face so that nothing is allocated per face.
+    putVertsHere    Must have room for FaceVertexCount(numCorners) vertices.
+Returns:
+    False if there are fewer than 3 corners or an index is out of range (the vertices are not
+    touched), otherwise true.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static bool MakeFaceVertices(const std::vector<glm::vec3> &vertPositions,
+    const std::vector<glm::vec3> &vertNormals, const OBJ_INDEX *indices, size_t numCorners,
+    ObjFaceScratch *scratch, MyVertex *putVertsHere)
+{
+    if (numCorners < 3)
+    {
+        return false;
+    }
+
+    scratch->_cornerPositions.resize(numCorners);
+    for (size_t cornerIndex = 0; cornerIndex < numCorners; cornerIndex++)
+    {
+        OBJ_INDEX positionIndex = indices[cornerIndex * 2];
+        if (!IndexIsValid(positionIndex, vertPositions.size()) ||
+            !IndexIsValid(indices[cornerIndex * 2 + 1], vertNormals.size()))
+        {
+            return false;
+        }
+        scratch->_cornerPositions[cornerIndex] = vertPositions[positionIndex - 1];
+    }
+
+    // the triangulator needs the whole position (the face may not be flat in XY), but the
+    // vertices are made from X and Y only
+    scratch->_triangulator.Triangulate(scratch->_cornerPositions.data(), numCorners,
+        &scratch->_triangles);
+    for (size_t triangleCorner = 0; triangleCorner < scratch->_triangles.size();
+        triangleCorner++)
+    {
+        // make triangles from the face and put the data into the geometry structure
+        // Note: For the sake of the this demo, which is in 2D, ignore the Z component.  These
+        // normals are meant for 3D and thus have a Z component, but right now that is being
+        // ignored, so the surface normals will not matter at render time.
+        size_t cornerIndex = scratch->_triangles[triangleCorner];
+        glm::vec2 position(scratch->_cornerPositions[cornerIndex]);
+        glm::vec2 normal(vertNormals[indices[cornerIndex * 2 + 1] - 1]);
+        putVertsHere[triangleCorner] = MyVertex(position, normal);
+    }
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Adds a line to the count for its type (see LoadStatistics::_lineCounts).
+Parameters:
+    lineType    From ClassifyObjLine(...).
+    lineCounts  Self-explanatory.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static void CountLine(ObjLineType lineType, BlenderLoad::LineCounts *lineCounts)
+{
+    switch (lineType)
+    {
+    case OBJ_LINE_OBJECT_NAME:
+        lineCounts->_objectNames++;
+        break;
+    case OBJ_LINE_VERTEX_POSITION:
+        lineCounts->_positions++;
+        break;
+    case OBJ_LINE_VERTEX_NORMAL:
+        lineCounts->_normals++;
+        break;
+    case OBJ_LINE_LINE:
+        lineCounts->_lines++;
+        break;
+    case OBJ_LINE_FACE:
+        lineCounts->_faces++;
+        break;
+    case OBJ_LINE_USE_MATERIAL:
+        lineCounts->_useMaterials++;
+        break;
+    case OBJ_LINE_SMOOTH_SHADING:
+        lineCounts->_smoothShading++;
+        break;
+    case OBJ_LINE_COMMENT:
+        lineCounts->_comments++;
+        break;
+    default:
+        lineCounts->_unknown++;
+        break;
+    }
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Keeps a line that the loader does not know what to do with as an example for the summary at
+    the end of the load (see ReportUnknownLines(...)), unless there are enough examples
+    already.
+
+    Note: Unknown lines used to be printed as they were found.  A file with a lot of them (a
+    "g" line per object, for example) spent more time writing to the console than parsing.
+Parameters:
+    state       Self-explanatory.
+    lineBegin   Pointer to the first character of the line.
+    lineEnd     Pointer to one past the last character of the line.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static void KeepUnknownLineSample(ObjParseState *state, const char *lineBegin,
+    const char *lineEnd)
+{
+    if (state->_unknownLineSamples.size() < state->_maxUnknownLineSamples)
+    {
+        state->_unknownLineSamples.push_back(std::string(lineBegin, lineEnd));
+    }
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Self-explanatory.
+Parameters:
+    startTime   Self-explanatory.
+Returns:
+    The time since startTime.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static double SecondsSince(const std::chrono::steady_clock::time_point &startTime)
+{
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    return elapsed.count();
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Welds an object's vertices (see VertexWeld.h) and picks the smallest index type that can
+    address them.  Line objects can also be stitched into strips (see LineStitch.h).
+Parameters:
+    geometryData    Self-explanatory.
+    stitchLines     See LoadOptions::_stitchLines.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static void WeldObject(GeometryData *geometryData, bool stitchLines)
+{
+    WeldVertices(&geometryData->_verts, &geometryData->_indices);
+    if (stitchLines && geometryData->_drawStyle == GL_LINES)
+    {
+        StitchLineStrips(geometryData->_verts.size(), &geometryData->_indices);
+        geometryData->_drawStyle = GL_LINE_STRIP;
+    }
+
+    // 0xFFFF is left out so that it stays free for use as a primitive restart index
+    geometryData->_indexType = (geometryData->_verts.size() < 0xFFFF) ?
+        GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Works out what welding (and stitching) saved for an object.  This only looks at the welded
+    output (every index, or every strip segment's two ends, stands for one of the original
+    vertices), so it works just as well on geometry that came out of the cache.
+Parameters:
+    objectName      Self-explanatory.
+    geometryData    Welded geometry.
+Returns:
+    Self-explanatory.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static BlenderLoad::WeldStatistics MakeWeldStatistics(const std::string &objectName,
+    const GeometryData &geometryData)
+{
+    size_t indexSizeBytes = (geometryData._indexType == GL_UNSIGNED_SHORT) ?
+        sizeof(unsigned short) : sizeof(unsigned int);
+
+    // a stitched line object (see LineStitch.h) has fewer indices than it had vertices
+    BlenderLoad::WeldStatistics objectStats;
+    objectStats._objectName = objectName;
+    objectStats._vertsBefore = (geometryData._drawStyle == GL_LINE_STRIP) ?
+        CountLineStripSegments(geometryData._indices) * 2 : geometryData._indices.size();
+    objectStats._vertsAfter = geometryData._verts.size();
+    objectStats._bytesBefore = objectStats._vertsBefore * sizeof(MyVertex);
+    objectStats._bytesAfter = (objectStats._vertsAfter * sizeof(MyVertex)) +
+        (geometryData._indices.size() * indexSizeBytes);
+    return objectStats;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Works out how far off an object will be if it is uploaded as Vertex2DQuantized, by
+    quantizing it the same way that SharedGeometryBuffer::Add(...) does and then undoing it.
+Parameters:
+    objectName      Self-explanatory.
+    geometryData    Self-explanatory.
+Returns:
+    Self-explanatory.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static BlenderLoad::QuantizationStatistics MakeQuantizationStatistics(
+    const std::string &objectName, const GeometryData &geometryData)
+{
+    BlenderLoad::QuantizationStatistics objectStats;
+    objectStats._objectName = objectName;
+    objectStats._maxPositionError = 0.0f;
+    objectStats._maxNormalError = 0.0f;
+
+    const std::vector<MyVertex> &verts = geometryData._verts;
+    PositionQuantization quantization = PositionQuantizationForBounds(verts);
+    for (size_t vertIndex = 0; vertIndex < verts.size(); vertIndex++)
+    {
+        const MyVertex &vertex = verts[vertIndex];
+        Vertex2DQuantized quantized(vertex, quantization);
+        glm::vec2 position = quantized.Position(quantization);
+        glm::vec2 normal = quantized.Normal();
+        objectStats._maxPositionError = std::max(objectStats._maxPositionError,
+            std::max(fabsf(position.x - vertex._position.x),
+            fabsf(position.y - vertex._position.y)));
+        objectStats._maxNormalError = std::max(objectStats._maxNormalError,
+            std::max(fabsf(normal.x - vertex._normal.x), fabsf(normal.y - vertex._normal.y)));
+    }
+
+    return objectStats;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Streaming only.  Hands the object that is currently being filled (if any) to the callback
+    and starts over with an empty one.  Called when the next "o" line shows up and at the end
+    of the file.
+Parameters:
+    state   Self-explanatory.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static void FinishStreamedObject(ObjParseState *state)
+{
+    if (state->_onObjectLoaded == 0 || state->_geometryData == 0)
+    {
+        return;
+    }
+
+    if (state->_weldStreamedObjects)
+    {
+        std::chrono::steady_clock::time_point weldStartTime = std::chrono::steady_clock::now();
+        WeldObject(&state->_streamedObject, state->_stitchLines);
+        state->_weldSeconds += SecondsSince(weldStartTime);
+        if (state->_streamedWeldStats != 0)
+        {
+            state->_streamedWeldStats->push_back(
+                MakeWeldStatistics(state->_streamedObjectName, state->_streamedObject));
+        }
+    }
+
+    if (state->_streamedQuantizationStats != 0)
+    {
+        state->_streamedQuantizationStats->push_back(
+            MakeQuantizationStatistics(state->_streamedObjectName, state->_streamedObject));
+    }
+
+    (*state->_onObjectLoaded)(state->_streamedObjectName, &state->_streamedObject);
+    state->_numStreamedObjects++;
+
+    // the callback may have moved out of it, so start over with a known state
+    state->_streamedObject = GeometryData();
+    state->_geometryData = 0;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Handles an "o" line: all faces and lines after this go into the named object until the next
+    "o" line.
+
+    Note: If there was a counting pass, a new object's vertex collection is allocated at its
+    final size right away.
+Parameters:
+    state       Self-explanatory.
+    nameBegin   Pointer to the first character of the object's name.
+    nameEnd     Pointer to one past the last character of the object's name.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static void BeginObject(ObjParseState *state, const char *nameBegin, const char *nameEnd)
+{
+    bool isNewObject = true;
+    if (state->_onObjectLoaded != 0)
+    {
+        FinishStreamedObject(state);
+        state->_streamedObjectName.assign(nameBegin, nameEnd);
+        state->_geometryData = &state->_streamedObject;
+    }
+    else
+    {
+        // make a new GeometryData object and stuff any face/line data into there
+        // Note: Add(...) returns the existing object if the name is already in there.
+        GeometryRegistry::HANDLE handle =
+            state->_putDataHere->Add(std::string(nameBegin, nameEnd), &isNewObject);
+        state->_geometryData = &state->_putDataHere->Geometry(handle);
+    }
+
+    if (isNewObject && !state->_expectedVertsByName.empty())
+    {
+        auto expectedItr = state->_expectedVertsByName.find(std::string(nameBegin, nameEnd));
+        if (expectedItr != state->_expectedVertsByName.end())
+        {
+            state->_geometryData->_verts.reserve(expectedItr->second);
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Parses a single line of the .obj file (after the header lines) and stuffs the results into
+    the parse state.  The line is read in place.  No copies are made.
+Parameters:
+    state       The vertex collections and the object that is currently being filled.
+    lineBegin   Pointer to the first character of the line.
+    lineEnd     Pointer to one past the last character of the line (excluding the '\n').
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static void ParseObjLine(ObjParseState *state, const char *lineBegin, const char *lineEnd)
+{
+    const char *argsBegin = 0;
+    ObjLineType lineType = ClassifyObjLine(lineBegin, &lineEnd, &argsBegin);
+    CountLine(lineType, &state->_lineCounts);
+    switch (lineType)
+    {
+    case OBJ_LINE_OBJECT_NAME:
+    {
+        // new object; the name runs from the end of the header until the end of the line
+        BeginObject(state, argsBegin, lineEnd);
+
+        // do NOT clear out the vertex position and normal collections because Blender OBJ
+        // files treat vertex values as being in a single, large collection
+        // Ex: Obj 1 is a flat plane and has a single vertex normal value.  The face
+        // description will use normal index 1.
+        // Ex: Obj 2 is a bent plane with 2 vertex normals.  The face descriptions will use
+        // normal indices 2 and 3.  They don't reset at 1.
+        break;
+    }
+    case OBJ_LINE_VERTEX_POSITION:
+    {
+        // as stated in the function description, expecting +Z to be up
+        state->_vertPositions.push_back(ParseVec3(argsBegin, lineEnd));
+        break;
+    }
+    case OBJ_LINE_VERTEX_NORMAL:
+    {
+        state->_vertNormals.push_back(ParseVec3(argsBegin, lineEnd));
+        break;
+    }
+    case OBJ_LINE_LINE:
+    {
+        // data comes in lines
+        // Note: I am assuming (for demo) that it only has lines.  It is possible for a
+        // shape to have both lines and faces, but that is when someone adds an edge between
+        // two vertices without merging the vertices.  For the sake of this demo, just
+        // assume that, if there is line in the shape's data, then the shape should be drawn
+        // with lines only.
+        GeometryData *geometryData = state->_geometryData;
+        if (geometryData == 0)
+        {
+            state->_numRecordsWithoutObject++;
+            break;
+        }
+        geometryData->_drawStyle = GL_LINES;
+
+        OBJ_INDEX indices[INDICES_PER_LINE];
+        ParseLineIndices(argsBegin, lineEnd, indices);
+        if (state->_positionIndexBase != 0)
+        {
+            RebaseRecordIndices(*state, lineType, indices, INDICES_PER_LINE);
+        }
+
+        // a bad record leaves no vertices behind
+        size_t numVertsBefore = geometryData->_verts.size();
+        geometryData->_verts.resize(numVertsBefore + VERTS_PER_LINE);
+        if (MakeLineVertices(state->_vertPositions, indices,
+            geometryData->_verts.data() + numVertsBefore))
+        {
+            state->_numVertsEmitted += VERTS_PER_LINE;
+        }
+        else
+        {
+            geometryData->_verts.resize(numVertsBefore);
+            state->_numBadRecords++;
+        }
+        break;
+    }
+    case OBJ_LINE_FACE:
+    {
+        // data comes in faces with any number of corners (usually quads)
+        // Note: Quads and n-gons have been deprecated in OpenGL for years, so I need to turn
+        // them into triangles.
+        GeometryData *geometryData = state->_geometryData;
+        if (geometryData == 0)
+        {
+            state->_numRecordsWithoutObject++;
+            break;
+        }
+        geometryData->_drawStyle = GL_TRIANGLES;
+
+        ObjFaceScratch &scratch = state->_faceScratch;
+        scratch._indices.clear();
+        size_t numCorners = ParseFaceIndices(argsBegin, lineEnd, &scratch._indices);
+        if (state->_positionIndexBase != 0 || state->_normalIndexBase != 0)
+        {
+            RebaseRecordIndices(*state, lineType, scratch._indices.data(),
+                scratch._indices.size());
+        }
+
+        // a bad record leaves no vertices behind
+        size_t numVertsBefore = geometryData->_verts.size();
+        geometryData->_verts.resize(numVertsBefore + FaceVertexCount(numCorners));
+        if (MakeFaceVertices(state->_vertPositions, state->_vertNormals,
+            scratch._indices.data(), numCorners, &scratch,
+            geometryData->_verts.data() + numVertsBefore))
+        {
+            state->_numVertsEmitted += FaceVertexCount(numCorners);
+        }
+        else
+        {
+            geometryData->_verts.resize(numVertsBefore);
+            state->_numBadRecords++;
+        }
+        break;
+    }
+    case OBJ_LINE_USE_MATERIAL:
+    {
+        // materials ignored in this demo
+        break;
+    }
+    case OBJ_LINE_SMOOTH_SHADING:
+    {
+        // smooth shading ignored in this demo
+        break;
+    }
+    case OBJ_LINE_COMMENT:
+    {
+        break;
+    }
+    default:
+    {
+        // ??unknown header??
+        // Note: Counted above and summarized at the end of the load.
+        KeepUnknownLineSample(state, lineBegin, lineEnd);
+        break;
+    }
+    }
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Checks that the text is an .obj file and skips past the lines at the top that Blender
+    always writes.
+Parameters:
+    textBegin   Pointer to the first character of the file.
+    textEnd     Pointer to one past the last character of the file.
+    filePath    For error reporting.
+Returns:
+    A pointer to the first line of actual data, or null if it is not an .obj file.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static const char *SkipObjHeader(const char *textBegin, const char *textEnd,
+    const std::string &filePath)
+{
+    if (textBegin == textEnd)
+    {
+        cout << "File '" << filePath << "' is empty" << endl;
+        return 0;
+    }
+
+    const char *lineBegin = textBegin;
+    const char *lineEnd = FindLineEnd(lineBegin, textEnd);
+    if (!LineHasObjTag(lineBegin, lineEnd))
+    {
+        cout << "File '" << filePath << "' is not an OBJ file" << endl;
+        return 0;
+    }
+
+    // skip the first line (checked above), "www.blender.org", and the material file (don't
+    // care in this demo)
+    for (int headerLineCount = 0; headerLineCount < 3 && lineBegin < textEnd; headerLineCount++)
+    {
+        lineEnd = FindLineEnd(lineBegin, textEnd);
+        lineBegin = (lineEnd == textEnd) ? textEnd : lineEnd + 1;
+    }
+
+    return lineBegin;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    The results of CountObjRecords(...).
+-----------------------------------------------------------------------------------------------*/
+struct ObjRecordCounts
+{
+    ObjRecordCounts() :
+        _numPositions(0),
+        _numNormals(0)
+    {
+    }
+
+    size_t _numPositions;
+    size_t _numNormals;
+
+    // how many vertices each object's faces and lines will turn into
+    // Note: An object name that shows up more than once gets the sum.
+    std::map<std::string, size_t> _vertsByName;
+};
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    The quick first pass for LoadOptions::_preallocate.  Classifies every line but doesn't parse
+    any numbers, which is where nearly all of the real parse's time goes.
+Parameters:
+    textBegin       Pointer to the first line after the header.
+    textEnd         Pointer to one past the last character of the text.
+    countObjects    If false, _vertsByName is left alone.  The chunk parser doesn't know which
+                    object its first records belong to, so it has no use for them.
+    counts          Self-explanatory.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static void CountObjRecords(const char *textBegin, const char *textEnd, bool countObjects,
+    ObjRecordCounts *counts)
+{
+    // records before the first object are ignored by the real parse, so don't count them
+    size_t *objectVertCount = 0;
+
+    const char *lineBegin = textBegin;
+    while (lineBegin < textEnd)
+    {
+        const char *lineEnd = FindLineEnd(lineBegin, textEnd);
+        const char *nextLineBegin = (lineEnd == textEnd) ? lineEnd : lineEnd + 1;
+
+        const char *argsBegin = 0;
+        switch (ClassifyObjLine(lineBegin, &lineEnd, &argsBegin))
+        {
+        case OBJ_LINE_OBJECT_NAME:
+            if (countObjects)
+            {
+                objectVertCount = &counts->_vertsByName[std::string(argsBegin, lineEnd)];
+            }
+            break;
+        case OBJ_LINE_VERTEX_POSITION:
+            counts->_numPositions++;
+            break;
+        case OBJ_LINE_VERTEX_NORMAL:
+            counts->_numNormals++;
+            break;
+        case OBJ_LINE_LINE:
+            if (objectVertCount != 0)
+            {
+                *objectVertCount += VERTS_PER_LINE;
+            }
+            break;
+        case OBJ_LINE_FACE:
+            if (objectVertCount != 0)
+            {
+                *objectVertCount += FaceVertexCount(CountFaceCorners(argsBegin, lineEnd));
+            }
+            break;
+        default:
+            break;
+        }
+
+        lineBegin = nextLineBegin;
+    }
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Reserves exactly enough room in the parse state for everything that CountObjRecords(...)
+    found, so that nothing is reallocated during the real parse.
+
+    Note: The objects' vertex counts are kept until each object's "o" line shows up (see
+    BeginObject(...)) so that the objects still go into the output in file order.
+Parameters:
+    counts  From CountObjRecords(...) with countObjects = true.  The vertex counts are moved
+            out.
+    state   Self-explanatory.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static void PreallocateObjParseState(ObjRecordCounts *counts, ObjParseState *state)
+{
+    state->_vertPositions.reserve(state->_vertPositions.size() + counts->_numPositions);
+    state->_vertNormals.reserve(state->_vertNormals.size() + counts->_numNormals);
+    if (state->_putDataHere != 0)
+    {
+        BlenderLoad::GEOMETRY_DATA_BY_NAME *geometry = state->_putDataHere;
+        geometry->Reserve(geometry->Size() + counts->_vertsByName.size());
+    }
+    state->_expectedVertsByName.swap(counts->_vertsByName);
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Walks through the text of an entire .obj file that is already in memory, one line at a
+    time, without copying any of it.
+Parameters:
+    textBegin   Pointer to the first character of the file.
+    textEnd     Pointer to one past the last character of the file.
+    filePath    For error reporting.
+    preallocate See LoadOptions::_preallocate.
+    state       Where the parsed data goes.
+    prescanSecondsOut   Gets how long the counting pass took (0 if there wasn't one).
+Returns:
+    True if the text looked like an .obj file, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static bool ParseObjText(const char *textBegin, const char *textEnd,
+    const std::string &filePath, bool preallocate, ObjParseState *state,
+    double *prescanSecondsOut)
+{
+    *prescanSecondsOut = 0.0;
+    const char *lineBegin = SkipObjHeader(textBegin, textEnd, filePath);
+    if (lineBegin == 0)
+    {
+        return false;
+    }
+
+    if (preallocate)
+    {
+        std::chrono::steady_clock::time_point prescanStartTime =
+            std::chrono::steady_clock::now();
+
+        ObjRecordCounts counts;
+        CountObjRecords(lineBegin, textEnd, true, &counts);
+        PreallocateObjParseState(&counts, state);
+
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - prescanStartTime;
+        *prescanSecondsOut = elapsed.count();
+    }
+
+    while (lineBegin < textEnd)
+    {
+        const char *lineEnd = FindLineEnd(lineBegin, textEnd);
+        ParseObjLine(state, lineBegin, lineEnd);
+        lineBegin = (lineEnd == textEnd) ? textEnd : lineEnd + 1;
+    }
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Handles one line of a decompressed .obj file for ParseCompressedObjText(...).  The first
+    few lines are checked and skipped like SkipObjHeader(...) does, and the rest are parsed.
+Parameters:
+    state       Where the parsed data goes.
+    lineNumber  How many lines came before this one.  Incremented.
+    filePath    For error reporting.
+    lineBegin   Pointer to the first character of the line.
+    lineEnd     Pointer to one past the last character of the line (excluding the '\n').
+Returns:
+    False if the first line showed that it is not an .obj file, otherwise true.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static bool ParseDecompressedObjLine(ObjParseState *state, size_t *lineNumber,
+    const std::string &filePath, const char *lineBegin, const char *lineEnd)
+{
+    size_t thisLineNumber = (*lineNumber)++;
+    if (thisLineNumber == 0 && !LineHasObjTag(lineBegin, lineEnd))
+    {
+        cout << "File '" << filePath << "' is not an OBJ file" << endl;
+        return false;
+    }
+
+    // skip the first line (checked above), "www.blender.org", and the material file
+    if (thisLineNumber >= 3)
+    {
+        ParseObjLine(state, lineBegin, lineEnd);
+    }
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Parses a compressed .obj file (see DecompressionStream) without ever holding all of the
+    decompressed text.  Each block is parsed on this thread while the next one is decompressed
+    on another.  Blocks are cut at arbitrary places, so the unfinished line at the end of one
+    block is carried over and finished with the start of the next.
+
+    Note: There is no counting pass (the text would have to be decompressed twice) and no
+    multithreaded parse (that needs all of the text up front), so everything is parsed in
+    order on this thread.
+Parameters:
+    compressedData      The compressed file's contents.
+    numCompressedBytes  Self-explanatory.
+    format              From CompressionFormatForPath(...).
+    filePath            For error reporting.
+    state               Where the parsed data goes.
+    bytesDecompressed   Gets the size of the decompressed text.
+Returns:
+    True if the file was decompressed and looked like an .obj file, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static bool ParseCompressedObjText(const char *compressedData, size_t numCompressedBytes,
+    CompressionFormat format, const std::string &filePath, ObjParseState *state,
+    unsigned long long *bytesDecompressed)
+{
+    *bytesDecompressed = 0;
+    DecompressionStream stream;
+    if (!stream.Start(compressedData, numCompressedBytes, format))
+    {
+        cout << "File '" << filePath << "' is " << CompressionFormatName(format)
+            << " compressed, but the loader was built without support for it" << endl;
+        return false;
+    }
+
+    std::vector<char> block;
+    std::string unfinishedLine;
+    size_t lineNumber = 0;
+    while (stream.NextBlock(&block))
+    {
+        *bytesDecompressed += block.size();
+        const char *blockEnd = block.data() + block.size();
+        const char *lineBegin = block.data();
+        if (!unfinishedLine.empty())
+        {
+            const char *lineEnd = FindLineEnd(lineBegin, blockEnd);
+            unfinishedLine.append(lineBegin, lineEnd);
+            if (lineEnd == blockEnd)
+            {
+                // still no newline; keep going
+                continue;
+            }
+
+            if (!ParseDecompressedObjLine(state, &lineNumber, filePath, unfinishedLine.data(),
+                unfinishedLine.data() + unfinishedLine.length()))
+            {
+                return false;
+            }
+            unfinishedLine.clear();
+            lineBegin = lineEnd + 1;
+        }
+
+        while (lineBegin < blockEnd)
+        {
+            const char *lineEnd = FindLineEnd(lineBegin, blockEnd);
+            if (lineEnd == blockEnd)
+            {
+                unfinishedLine.assign(lineBegin, blockEnd);
+                break;
+            }
+
+            if (!ParseDecompressedObjLine(state, &lineNumber, filePath, lineBegin, lineEnd))
+            {
+                return false;
+            }
+            lineBegin = lineEnd + 1;
+        }
+    }
+
+    if (stream.Failed())
+    {
+        cout << "File '" << filePath << "' could not be decompressed (corrupt or cut off)"
+            << endl;
+        return false;
+    }
+
+    // the last line doesn't need a newline
+    if (!unfinishedLine.empty() && !ParseDecompressedObjLine(state, &lineNumber, filePath,
+        unfinishedLine.data(), unfinishedLine.data() + unfinishedLine.length()))
+    {
+        return false;
+    }
+
+    if (lineNumber == 0)
+    {
+        cout << "File '" << filePath << "' is empty" << endl;
+        return false;
+    }
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    The lightweight pass for BlenderLoad::GetObjectIndex(...).  Like CountObjRecords(...), it
+    classifies every line without parsing any numbers, and it notes where each "o" block starts
+    and ends along with how many positions and normals came before it.
+Parameters:
+    textBegin       Pointer to the first character of the file.
+    textEnd         Pointer to one past the last character of the file.
+    filePath        For error reporting.
+    putIndexHere    Cleared, then gets one entry per "o" block.
+Returns:
+    True if the text looked like an .obj file, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static bool BuildObjectIndex(const char *textBegin, const char *textEnd,
+    const std::string &filePath, BlenderLoad::OBJECT_INDEX *putIndexHere)
+{
+    putIndexHere->clear();
+    const char *lineBegin = SkipObjHeader(textBegin, textEnd, filePath);
+    if (lineBegin == 0)
+    {
+        return false;
+    }
+
+    unsigned long long numPositions = 0;
+    unsigned long long numNormals = 0;
+    while (lineBegin < textEnd)
+    {
+        const char *lineEnd = FindLineEnd(lineBegin, textEnd);
+        const char *nextLineBegin = (lineEnd == textEnd) ? lineEnd : lineEnd + 1;
+
+        const char *argsBegin = 0;
+        switch (ClassifyObjLine(lineBegin, &lineEnd, &argsBegin))
+        {
+        case OBJ_LINE_OBJECT_NAME:
+        {
+            // the previous block ends where this one begins
+            if (!putIndexHere->empty())
+            {
+                putIndexHere->back()._textEnd = lineBegin - textBegin;
+            }
+
+            BlenderLoad::ObjectIndexEntry entry;
+            entry._name.assign(argsBegin, lineEnd);
+            entry._textBegin = lineBegin - textBegin;
+            entry._textEnd = textEnd - textBegin;
+            entry._positionsBefore = numPositions;
+            entry._normalsBefore = numNormals;
+            putIndexHere->push_back(entry);
+            break;
+        }
+        case OBJ_LINE_VERTEX_POSITION:
+            numPositions++;
+            break;
+        case OBJ_LINE_VERTEX_NORMAL:
+            numNormals++;
+            break;
+        default:
+            break;
+        }
+
+        lineBegin = nextLineBegin;
+    }
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Gets the object index for a file that is already open, from the index file next to it if
+    that is still good, otherwise from BuildObjectIndex(...).
+Parameters:
+    objFile         The memory-mapped .obj file.
+    filePath        Its path, so that the index file can be found.
+    useIndexCache   If false, the index is always built and never saved.
+    putIndexHere    Self-explanatory.
+Returns:
+    True if the index was loaded or built, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static bool ReadOrBuildObjectIndex(const MemoryMappedFile &objFile, const std::string &filePath,
+    bool useIndexCache, BlenderLoad::OBJECT_INDEX *putIndexHere)
+{
+    if (CompressionFormatForPath(filePath) != COMPRESSION_NONE)
+    {
+        // the byte ranges would be into the decompressed text, which can't be jumped into
+        cout << "Objects can't be picked out of a compressed file without decompressing all "
+            "of it: " << filePath << endl;
+        return false;
+    }
+
+    std::string indexPath = GeometryCache::IndexPathFor(filePath);
+    unsigned long long objHash = 0;
+    if (useIndexCache)
+    {
+        objHash = GeometryCache::HashBytes(objFile.Data(), objFile.Size());
+        if (GeometryCache::ReadObjectIndex(indexPath, objFile.Size(), objHash, putIndexHere))
+        {
+            return true;
+        }
+    }
+
+    if (!BuildObjectIndex(objFile.Data(), objFile.Data() + objFile.Size(), filePath,
+        putIndexHere))
+    {
+        return false;
+    }
+
+    if (useIndexCache &&
+        !GeometryCache::WriteObjectIndex(indexPath, objFile.Size(), objHash, *putIndexHere))
+    {
+        // not fatal; the next run will just build it again
+        cout << "Could not write the object index: " << indexPath << endl;
+    }
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Parses a single "o" block on its own.  Only the positions and normals inside the block are
+    read, so the global indices in the block are made relative to them (see
+    RebaseRecordIndices(...)).
+
+    Note: Blender writes each object's positions and normals inside its own block, so this
+    works for any file that it exports.  A face or line that uses a position or normal from
+    another block is counted as a bad record.
+Parameters:
+    blockBegin      Pointer to the block's "o" line.
+    blockEnd        Pointer to one past the block's last line.
+    entry           The block's entry in the object index.
+    preallocate     See LoadOptions::_preallocate.
+    state           Where the parsed data goes.  Any positions and normals from the last block
+                    are thrown away.
+    prescanSecondsOut   Gets how long the counting pass took (0 if there wasn't one).
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static void ParseObjBlock(const char *blockBegin, const char *blockEnd,
+    const BlenderLoad::ObjectIndexEntry &entry, bool preallocate, ObjParseState *state,
+    double *prescanSecondsOut)
+{
+    state->_vertPositions.clear();
+    state->_vertNormals.clear();
+    state->_positionIndexBase = static_cast<OBJ_INDEX>(entry._positionsBefore);
+    state->_normalIndexBase = static_cast<OBJ_INDEX>(entry._normalsBefore);
+    state->_geometryData = 0;
+
+    *prescanSecondsOut = 0.0;
+    if (preallocate)
+    {
+        std::chrono::steady_clock::time_point prescanStartTime =
+            std::chrono::steady_clock::now();
+
+        ObjRecordCounts counts;
+        CountObjRecords(blockBegin, blockEnd, true, &counts);
+        PreallocateObjParseState(&counts, state);
+
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - prescanStartTime;
+        *prescanSecondsOut = elapsed.count();
+    }
+
+    const char *lineBegin = blockBegin;
+    while (lineBegin < blockEnd)
+    {
+        const char *lineEnd = FindLineEnd(lineBegin, blockEnd);
+        ParseObjLine(state, lineBegin, lineEnd);
+        lineBegin = (lineEnd == blockEnd) ? blockEnd : lineEnd + 1;
+    }
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    The original loading approach: std::ifstream and std::getline(...).  Every line is copied
+    into a std::string before it is parsed.  This is kept around so that the memory-mapped
+    path's throughput can be compared against it.
+Parameters:
+    filePath    The path to the .obj file
+    state       Where the parsed data goes.
+    bytesRead   Gets the number of bytes that were pulled out of the file.
+Returns:
+    True if the file could be opened and looked like an .obj file, otherwise false.
+Exception:  Safe
+Creator:    John Cox (2-13-2016)
+-----------------------------------------------------------------------------------------------*/
+static bool ParseObjFileStream(const std::string &filePath, ObjParseState *state,
+    unsigned long long *bytesRead)
+{
+    std::ifstream fileStream(filePath, std::ios::in);
+    if (!fileStream.is_open())
+    {
+        cout << "Could not find the .obj file: " << filePath << endl;
+        return false;
+    }
+
+    std::string line;
+    std::getline(fileStream, line);
+    *bytesRead += line.length() + 1;
+    if (!LineHasObjTag(line.data(), line.data() + line.length()))
+    {
+        cout << "File '" << filePath << "' is not an OBJ file" << endl;
+        return false;
+    }
+
+    // "www.blender.org"
+    std::getline(fileStream, line);
+    *bytesRead += line.length() + 1;
+
+    // material file (don't care in this demo)
+    std::getline(fileStream, line);
+    *bytesRead += line.length() + 1;
+
+    while (std::getline(fileStream, line))
+    {
+        *bytesRead += line.length() + 1;
+        ParseObjLine(state, line.data(), line.data() + line.length());
+    }
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    The face and line records of a single object within a single chunk of the file.  The
+    records are stored as the raw 1-based indices from the file and are only turned into
+    vertices after all chunks have been parsed.
+
+    Note: A chunk boundary can land in the middle of an object.  In that case the next chunk
+    starts with an object that has no name, and its records belong to whatever object the
+    previous chunk ended in.
+-----------------------------------------------------------------------------------------------*/
+struct ObjChunkObject
+{
+    ObjChunkObject() :
+        _hasName(false),
+        _drawStyle(0),
+        _numVerts(0),
+        _target(GeometryRegistry::NO_HANDLE),
+        _targetOffset(0),
+        _numGoodVerts(0)
+    {
+    }
+
+    bool _hasName;
+    std::string _name;
+
+    // the draw style of the last record, or 0 if there were no records
+    unsigned int _drawStyle;
+
+    // OBJ_LINE_LINE or OBJ_LINE_FACE, in file order
+    // Note: A line consumes INDICES_PER_LINE indices.  A face consumes its corner count
+    // followed by a position-normal pair per corner.
+    std::vector<unsigned char> _recordTypes;
+    std::vector<OBJ_INDEX> _indices;
+
+    // how many vertices the records will turn into
+    size_t _numVerts;
+
+    // filled out during the fix-up pass
+    // Note: A handle rather than a pointer because later objects are still being added to the
+    // registry (which may move it) during the fix-up pass.
+    GeometryRegistry::HANDLE _target;
+    size_t _targetOffset;
+
+    // filled out during the second pass; less than _numVerts if any record was bad, in which
+    // case the good records' vertices are packed at the start of the reserved space
+    size_t _numGoodVerts;
+};
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Everything that a single worker thread pulls out of its piece of the file.
+-----------------------------------------------------------------------------------------------*/
+struct ObjChunk
+{
+    ObjChunk() :
+        _textBegin(0),
+        _textEnd(0),
+        _preallocate(false),
+        _prescanSeconds(0.0),
+        _maxUnknownLineSamples(0),
+        _numBadRecords(0)
+    {
+    }
+
+    // the chunk always starts at the beginning of a line and ends just after a '\n' (or at the
+    // end of the file)
+    const char *_textBegin;
+    const char *_textEnd;
+
+    // see LoadOptions::_preallocate
+    bool _preallocate;
+
+    // how long this chunk's counting pass took (0 if there wasn't one)
+    double _prescanSeconds;
+
+    std::vector<glm::vec3> _vertPositions;
+    std::vector<glm::vec3> _vertNormals;
+    std::vector<ObjChunkObject> _objects;
+
+    // unknown lines are merged after all threads are done so that the samples are the first
+    // ones in the file
+    BlenderLoad::LineCounts _lineCounts;
+    size_t _maxUnknownLineSamples;
+    std::vector<std::pair<const char *, const char *>> _unknownLineSamples;
+
+    // faces and lines that refer to a position or normal that doesn't exist
+    size_t _numBadRecords;
+};
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Worker thread body for the first pass of the multithreaded loader.  Reads all positions,
+    normals, and face/line indices out of the chunk's text.  Nothing is resolved here because
+    the indices are global to the whole file.
+Parameters:
+    chunk   The text range is read from here, and the results are put back into it.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static void ParseObjChunk(ObjChunk *chunk)
+{
+    if (chunk->_preallocate)
+    {
+        // Note: The vertices don't need this.  The fix-up pass sizes them exactly anyway.
+        std::chrono::steady_clock::time_point prescanStartTime =
+            std::chrono::steady_clock::now();
+        ObjRecordCounts counts;
+        CountObjRecords(chunk->_textBegin, chunk->_textEnd, false, &counts);
+        chunk->_prescanSeconds = SecondsSince(prescanStartTime);
+        chunk->_vertPositions.reserve(counts._numPositions);
+        chunk->_vertNormals.reserve(counts._numNormals);
+    }
+
+    const char *lineBegin = chunk->_textBegin;
+    while (lineBegin < chunk->_textEnd)
+    {
+        const char *lineEnd = FindLineEnd(lineBegin, chunk->_textEnd);
+        const char *nextLineBegin = (lineEnd == chunk->_textEnd) ? lineEnd : lineEnd + 1;
+
+        const char *argsBegin = 0;
+        ObjLineType lineType = ClassifyObjLine(lineBegin, &lineEnd, &argsBegin);
+        CountLine(lineType, &chunk->_lineCounts);
+        switch (lineType)
+        {
+        case OBJ_LINE_OBJECT_NAME:
+        {
+            chunk->_objects.push_back(ObjChunkObject());
+            chunk->_objects.back()._hasName = true;
+            chunk->_objects.back()._name.assign(argsBegin, lineEnd);
+            break;
+        }
+        case OBJ_LINE_VERTEX_POSITION:
+        {
+            chunk->_vertPositions.push_back(ParseVec3(argsBegin, lineEnd));
+            break;
+        }
+        case OBJ_LINE_VERTEX_NORMAL:
+        {
+            chunk->_vertNormals.push_back(ParseVec3(argsBegin, lineEnd));
+            break;
+        }
+        case OBJ_LINE_LINE:
+        case OBJ_LINE_FACE:
+        {
+            if (chunk->_objects.empty())
+            {
+                // continuation of the previous chunk's last object
+                chunk->_objects.push_back(ObjChunkObject());
+            }
+
+            ObjChunkObject &chunkObject = chunk->_objects.back();
+            chunkObject._recordTypes.push_back(static_cast<unsigned char>(lineType));
+            size_t numIndicesBefore = chunkObject._indices.size();
+            if (lineType == OBJ_LINE_LINE)
+            {
+                chunkObject._drawStyle = GL_LINES;
+                chunkObject._numVerts += VERTS_PER_LINE;
+                chunkObject._indices.resize(numIndicesBefore + INDICES_PER_LINE);
+                ParseLineIndices(argsBegin, lineEnd,
+                    chunkObject._indices.data() + numIndicesBefore);
+            }
+            else
+            {
+                chunkObject._drawStyle = GL_TRIANGLES;
+                chunkObject._indices.push_back(0);
+                size_t numCorners = ParseFaceIndices(argsBegin, lineEnd, &chunkObject._indices);
+                chunkObject._indices[numIndicesBefore] = static_cast<OBJ_INDEX>(numCorners);
+                chunkObject._numVerts += FaceVertexCount(numCorners);
+            }
+            break;
+        }
+        case OBJ_LINE_USE_MATERIAL:
+        case OBJ_LINE_SMOOTH_SHADING:
+        case OBJ_LINE_COMMENT:
+        {
+            // ignored in this demo
+            break;
+        }
+        default:
+        {
+            if (chunk->_unknownLineSamples.size() < chunk->_maxUnknownLineSamples)
+            {
+                chunk->_unknownLineSamples.push_back(std::make_pair(lineBegin, lineEnd));
+            }
+            break;
+        }
+        }
+
+        lineBegin = nextLineBegin;
+    }
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Worker thread body for the second pass of the multithreaded loader.  Turns the records of
+    each of the chunk's objects into vertices and writes them into the space that the fix-up
+    pass reserved for them in the target GeometryData.
+
+    Note: A bad record's vertices are written over by the next record, so the good ones end up
+    packed together (see RemoveBadRecordVertices(...)).
+Parameters:
+    chunk           The chunk whose records will be resolved.
+    vertPositions   Every position in the file.
+    vertNormals     Every normal in the file.
+    geometry        Where the fix-up pass put the chunk's objects.  Not added to, so every
+                    thread can use it at once.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static void MakeObjChunkVertices(ObjChunk *chunk, const std::vector<glm::vec3> &vertPositions,
+    const std::vector<glm::vec3> &vertNormals, BlenderLoad::GEOMETRY_DATA_BY_NAME *geometry)
+{
+    ObjFaceScratch faceScratch;
+    for (size_t objectIndex = 0; objectIndex < chunk->_objects.size(); objectIndex++)
+    {
+        ObjChunkObject &chunkObject = chunk->_objects[objectIndex];
+        if (chunkObject._target == GeometryRegistry::NO_HANDLE)
+        {
+            continue;
+        }
+
+        GeometryData &target = geometry->Geometry(chunkObject._target);
+        MyVertex *firstVert = target._verts.data() + chunkObject._targetOffset;
+        MyVertex *putVertsHere = firstVert;
+        const OBJ_INDEX *indices = chunkObject._indices.data();
+        for (size_t recordIndex = 0; recordIndex < chunkObject._recordTypes.size(); recordIndex++)
+        {
+            if (chunkObject._recordTypes[recordIndex] == OBJ_LINE_LINE)
+            {
+                if (MakeLineVertices(vertPositions, indices, putVertsHere))
+                {
+                    putVertsHere += VERTS_PER_LINE;
+                }
+                else
+                {
+                    chunk->_numBadRecords++;
+                }
+                indices += INDICES_PER_LINE;
+            }
+            else
+            {
+                size_t numCorners = static_cast<size_t>(indices[0]);
+                if (MakeFaceVertices(vertPositions, vertNormals, indices + 1, numCorners,
+                    &faceScratch, putVertsHere))
+                {
+                    putVertsHere += FaceVertexCount(numCorners);
+                }
+                else
+                {
+                    chunk->_numBadRecords++;
+                }
+                indices += 1 + (numCorners * 2);
+            }
+        }
+        chunkObject._numGoodVerts = putVertsHere - firstVert;
+    }
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Only needed if the multithreaded loader found bad records.  The fix-up pass reserved room
+    for every record, but the second pass only wrote the good ones (see
+    MakeObjChunkVertices(...)), so each chunk object's reserved range ends in unused vertices.
+    This slides each target's good vertices together, in file order, and trims the rest, so
+    that the result matches what ParseObjText(...) leaves behind.
+Parameters:
+    chunks  After the second pass.
+    state   The targets are in here, and the emitted vertex count is corrected.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static void RemoveBadRecordVertices(std::vector<ObjChunk> *chunks, ObjParseState *state)
+{
+    // where each target's next good vertex goes
+    // Note: A target's ranges were reserved in file order, so its first range is where its
+    // vertices from this file start.
+    std::map<GeometryRegistry::HANDLE, size_t> nextVertByTarget;
+    for (size_t chunkIndex = 0; chunkIndex < chunks->size(); chunkIndex++)
+    {
+        std::vector<ObjChunkObject> &objects = (*chunks)[chunkIndex]._objects;
+        for (size_t objectIndex = 0; objectIndex < objects.size(); objectIndex++)
+        {
+            const ObjChunkObject &chunkObject = objects[objectIndex];
+            if (chunkObject._target == GeometryRegistry::NO_HANDLE)
+            {
+                continue;
+            }
+
+            size_t &nextVert = nextVertByTarget.insert(
+                std::make_pair(chunkObject._target, chunkObject._targetOffset)).first->second;
+            std::vector<MyVertex> &verts =
+                state->_putDataHere->Geometry(chunkObject._target)._verts;
+            std::move(verts.begin() + chunkObject._targetOffset,
+                verts.begin() + chunkObject._targetOffset + chunkObject._numGoodVerts,
+                verts.begin() + nextVert);
+            nextVert += chunkObject._numGoodVerts;
+            state->_numVertsEmitted -= chunkObject._numVerts - chunkObject._numGoodVerts;
+        }
+    }
+
+    for (auto targetItr = nextVertByTarget.begin(); targetItr != nextVertByTarget.end();
+        ++targetItr)
+    {
+        state->_putDataHere->Geometry(targetItr->first)._verts.resize(targetItr->second);
+    }
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    The multithreaded version of ParseObjText(...).  The text is split into chunks at line
+    boundaries and each chunk is parsed on its own thread.  The chunks are then stitched back
+    together in file order on this thread, and finally the face/line indices are resolved into
+    vertices on the worker threads again.
+
+    Note: Blender numbers positions and normals across the whole file, so the indices in the
+    file do not need any adjustment.  Once every chunk's positions and normals are laid end to
+    end in file order, the global 1-based indices line up with them.
+
+    Also Note: The output is byte-for-byte the same as ParseObjText(...).  Records are resolved
+    with the same functions and each object's vertices end up in file order.  The one
+    difference is that a (malformed) face that refers to a position further down in the file is
+    accepted here but rejected by ParseObjText(...).
+Parameters:
+    textBegin   Pointer to the first character of the file.
+    textEnd     Pointer to one past the last character of the file.
+    filePath    For error reporting.
+    numThreads  How many worker threads to use.  Less may be used for small files.
+    preallocate See LoadOptions::_preallocate.  Each worker counts its own chunk.
+    state       Where the parsed data goes.
+    prescanSecondsOut   Gets how long the slowest worker's counting pass took (0 if there
+                        wasn't one).  The workers count at the same time, so this is how much
+                        the counting added to the wall clock time.
+Returns:
+    True if the text looked like an .obj file, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static bool ParseObjTextMultithreaded(const char *textBegin, const char *textEnd,
+    const std::string &filePath, unsigned int numThreads, bool preallocate,
+    ObjParseState *state, double *prescanSecondsOut)
+{
+    *prescanSecondsOut = 0.0;
+    const char *dataBegin = SkipObjHeader(textBegin, textEnd, filePath);
+    if (dataBegin == 0)
+    {
+        return false;
+    }
+
+    size_t numDataBytes = textEnd - dataBegin;
+    size_t numChunks = std::min(static_cast<size_t>(numThreads),
+        numDataBytes / MIN_BYTES_PER_THREAD);
+    numChunks = std::max(numChunks, static_cast<size_t>(1));
+
+    // split at line boundaries
+    // Note: Each chunk boundary is moved forward to just after the next newline so that no
+    // line is cut in half.  Chunks may come out empty if a line is enormous, which is fine.
+    std::vector<ObjChunk> chunks(numChunks);
+    const char *chunkBegin = dataBegin;
+    for (size_t chunkIndex = 0; chunkIndex < numChunks; chunkIndex++)
+    {
+        const char *chunkEnd = textEnd;
+        if (chunkIndex + 1 < numChunks)
+        {
+            chunkEnd = std::max(chunkBegin,
+                dataBegin + (numDataBytes / numChunks) * (chunkIndex + 1));
+            chunkEnd = FindLineEnd(chunkEnd, textEnd);
+            chunkEnd = (chunkEnd == textEnd) ? textEnd : chunkEnd + 1;
+        }
+
+        chunks[chunkIndex]._textBegin = chunkBegin;
+        chunks[chunkIndex]._textEnd = chunkEnd;
+        chunks[chunkIndex]._preallocate = preallocate;
+        chunks[chunkIndex]._maxUnknownLineSamples = state->_maxUnknownLineSamples;
+        chunkBegin = chunkEnd;
+    }
+
+    // first pass: read everything
+    std::vector<std::thread> workers;
+    for (size_t chunkIndex = 1; chunkIndex < numChunks; chunkIndex++)
+    {
+        workers.push_back(std::thread(ParseObjChunk, &chunks[chunkIndex]));
+    }
+    ParseObjChunk(&chunks[0]);
+    for (size_t threadIndex = 0; threadIndex < workers.size(); threadIndex++)
+    {
+        workers[threadIndex].join();
+    }
+    workers.clear();
+
+    for (size_t chunkIndex = 0; chunkIndex < numChunks; chunkIndex++)
+    {
+        *prescanSecondsOut = std::max(*prescanSecondsOut, chunks[chunkIndex]._prescanSeconds);
+    }
+
+    // fix-up: lay out the positions and normals in file order, then find each chunk object's
+    // geometry and reserve space for its vertices
+    size_t numPositions = 0;
+    size_t numNormals = 0;
+    size_t numObjects = 0;
+    for (size_t chunkIndex = 0; chunkIndex < numChunks; chunkIndex++)
+    {
+        numPositions += chunks[chunkIndex]._vertPositions.size();
+        numNormals += chunks[chunkIndex]._vertNormals.size();
+        numObjects += chunks[chunkIndex]._objects.size();
+    }
+
+    state->_vertPositions.reserve(state->_vertPositions.size() + numPositions);
+    state->_vertNormals.reserve(state->_vertNormals.size() + numNormals);
+    state->_putDataHere->Reserve(state->_putDataHere->Size() + numObjects);
+
+    // the object that the records are going into (carries over from one chunk to the next)
+    GeometryRegistry::HANDLE currentObject = GeometryRegistry::NO_HANDLE;
+    for (size_t chunkIndex = 0; chunkIndex < numChunks; chunkIndex++)
+    {
+        ObjChunk &chunk = chunks[chunkIndex];
+        state->_vertPositions.insert(state->_vertPositions.end(),
+            chunk._vertPositions.begin(), chunk._vertPositions.end());
+        state->_vertNormals.insert(state->_vertNormals.end(),
+            chunk._vertNormals.begin(), chunk._vertNormals.end());
+
+        // no longer needed, so give the memory back
+        std::vector<glm::vec3>().swap(chunk._vertPositions);
+        std::vector<glm::vec3>().swap(chunk._vertNormals);
+
+        state->_lineCounts.Add(chunk._lineCounts);
+        for (size_t sampleIndex = 0; sampleIndex < chunk._unknownLineSamples.size();
+            sampleIndex++)
+        {
+            KeepUnknownLineSample(state, chunk._unknownLineSamples[sampleIndex].first,
+                chunk._unknownLineSamples[sampleIndex].second);
+        }
+
+        for (size_t objectIndex = 0; objectIndex < chunk._objects.size(); objectIndex++)
+        {
+            ObjChunkObject &chunkObject = chunk._objects[objectIndex];
+            if (chunkObject._hasName)
+            {
+                currentObject = state->_putDataHere->Add(chunkObject._name);
+            }
+
+            if (currentObject == GeometryRegistry::NO_HANDLE)
+            {
+                state->_numRecordsWithoutObject += chunkObject._recordTypes.size();
+                continue;
+            }
+
+            if (chunkObject._numVerts == 0)
+            {
+                continue;
+            }
+
+            GeometryData &geometryData = state->_putDataHere->Geometry(currentObject);
+            geometryData._drawStyle = chunkObject._drawStyle;
+            chunkObject._target = currentObject;
+            chunkObject._targetOffset = geometryData._verts.size();
+            geometryData._verts.resize(chunkObject._targetOffset + chunkObject._numVerts);
+            state->_numVertsEmitted += chunkObject._numVerts;
+        }
+    }
+
+    // second pass: resolve the indices into vertices
+    // Note: Every chunk object writes to its own range, so no synchronization is needed.
+    for (size_t chunkIndex = 1; chunkIndex < numChunks; chunkIndex++)
+    {
+        workers.push_back(std::thread(MakeObjChunkVertices, &chunks[chunkIndex],
+            std::cref(state->_vertPositions), std::cref(state->_vertNormals),
+            state->_putDataHere));
+    }
+    MakeObjChunkVertices(&chunks[0], state->_vertPositions, state->_vertNormals,
+        state->_putDataHere);
+    for (size_t threadIndex = 0; threadIndex < workers.size(); threadIndex++)
+    {
+        workers[threadIndex].join();
+    }
+
+    size_t numBadRecordsBefore = state->_numBadRecords;
+    for (size_t chunkIndex = 0; chunkIndex < numChunks; chunkIndex++)
+    {
+        state->_numBadRecords += chunks[chunkIndex]._numBadRecords;
+    }
+    if (state->_numBadRecords != numBadRecordsBefore)
+    {
+        RemoveBadRecordVertices(&chunks, state);
+    }
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Ensures that the options start out as the fast, single-threaded path with the binary
+    cache turned on.
+Parameters: None
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+BlenderLoad::LoadOptions::LoadOptions() :
+    _useMemoryMap(true),
+    _numThreads(1),
+    _useBinaryCache(true),
+    _preallocate(true),
+    _weldVertices(false),
+    _stitchLines(false),
+    _quantizeVertices(false),
+    _instanceCopies(false),
+    _maxUnknownLineSamples(5)
+{
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Ensures that the counts start out zeroed.
+Parameters: None
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+BlenderLoad::LineCounts::LineCounts() :
+    _objectNames(0),
+    _positions(0),
+    _normals(0),
+    _lines(0),
+    _faces(0),
+    _useMaterials(0),
+    _smoothShading(0),
+    _comments(0),
+    _unknown(0)
+{
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Adds another set of counts (from another chunk or file) to these.
+Parameters:
+    other   Self-explanatory.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+void BlenderLoad::LineCounts::Add(const LineCounts &other)
+{
+    _objectNames += other._objectNames;
+    _positions += other._positions;
+    _normals += other._normals;
+    _lines += other._lines;
+    _faces += other._faces;
+    _useMaterials += other._useMaterials;
+    _smoothShading += other._smoothShading;
+    _comments += other._comments;
+    _unknown += other._unknown;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Self-explanatory.
+Parameters: None
+Returns:
+    The number of lines of every kind.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+unsigned long long BlenderLoad::LineCounts::Total() const
+{
+    return _objectNames + _positions + _normals + _lines + _faces + _useMaterials +
+        _smoothShading + _comments + _unknown;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Ensures that the statistics start out zeroed.
+Parameters: None
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+BlenderLoad::LoadStatistics::LoadStatistics() :
+    _bytesParsed(0),
+    _parseSeconds(0.0),
+    _compressedBytes(0),
+    _loadedFromCache(false),
+    _prescanSeconds(0.0),
+    _weldSeconds(0.0),
+    _cacheSeconds(0.0),
+    _numVertsEmitted(0),
+    _numObjects(0),
+    _peakResidentBytes(0)
+{
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Calculates the sustained parse throughput for the last load.
+
+    Note: A load out of the binary cache didn't parse any text, so it has no parse throughput.
+Parameters: None
+Returns:
+    Megabytes (1024 * 1024 bytes) per second, or 0 if nothing was timed or the geometry came
+    out of the binary cache.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+double BlenderLoad::LoadStatistics::MegabytesPerSecond() const
+{
+    if (_parseSeconds <= 0.0 || _loadedFromCache)
+    {
+        return 0.0;
+    }
+
+    return (static_cast<double>(_bytesParsed) / (1024.0 * 1024.0)) / _parseSeconds;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Welds every object in the output collection (see WeldObject(...)).
+Parameters:
+    state   Self-explanatory.  The time it took is added to _weldSeconds.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static void WeldGeometry(ObjParseState *state)
+{
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    BlenderLoad::GEOMETRY_DATA_BY_NAME *geometry = state->_putDataHere;
+    for (GeometryRegistry::HANDLE handle = 0; handle < geometry->Size(); handle++)
+    {
+        WeldObject(&geometry->Geometry(handle), state->_stitchLines);
+    }
+    state->_weldSeconds += SecondsSince(startTime);
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Works out what welding saved for each object (see MakeWeldStatistics(...)) and how far off
+    quantization will make it (see MakeQuantizationStatistics(...)), if the options asked for
+    those.
+Parameters:
+    geometry    The finished output.
+    options     Self-explanatory.
+    stats       Gets one entry per object in each of the statistics that were asked for.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static void CollectObjectStatistics(const BlenderLoad::GEOMETRY_DATA_BY_NAME &geometry,
+    const BlenderLoad::LoadOptions &options, BlenderLoad::LoadStatistics *stats)
+{
+    stats->_weldStats.clear();
+    stats->_quantizationStats.clear();
+    for (GeometryRegistry::HANDLE handle = 0; handle < geometry.Size(); handle++)
+    {
+        if (options._weldVertices)
+        {
+            stats->_weldStats.push_back(
+                MakeWeldStatistics(geometry.Name(handle), geometry.Geometry(handle)));
+        }
+        if (options._quantizeVertices)
+        {
+            stats->_quantizationStats.push_back(
+                MakeQuantizationStatistics(geometry.Name(handle), geometry.Geometry(handle)));
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Starts the statistics over and fills out everything except for the welding results, the
+    compressed size, and the binary cache time, which only the caller knows.
+Parameters:
+    startTime       When the load started.
+    bytesParsed     Self-explanatory.
+    prescanSeconds  See LoadStatistics::_prescanSeconds.
+    loadedFromCache Self-explanatory.
+    state           After parsing the whole file, or null if nothing was parsed.
+    stats           Self-explanatory.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static void FillLoadStatistics(const std::chrono::steady_clock::time_point &startTime,
+    unsigned long long bytesParsed, double prescanSeconds, bool loadedFromCache,
+    const ObjParseState *state, BlenderLoad::LoadStatistics *stats)
+{
+    *stats = BlenderLoad::LoadStatistics();
+    stats->_bytesParsed = bytesParsed;
+    stats->_parseSeconds = SecondsSince(startTime);
+    stats->_loadedFromCache = loadedFromCache;
+    stats->_prescanSeconds = prescanSeconds;
+    stats->_peakResidentBytes = PeakResidentBytes();
+    if (state != 0)
+    {
+        stats->_weldSeconds = state->_weldSeconds;
+        stats->_lineCounts = state->_lineCounts;
+        stats->_unknownLineSamples = state->_unknownLineSamples;
+        stats->_numVertsEmitted = state->_numVertsEmitted;
+        stats->_numObjects = (state->_putDataHere != 0) ?
+            state->_putDataHere->Size() : state->_numStreamedObjects;
+    }
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Prints one summary of the lines that the loader didn't recognize, with the examples that
+    were kept (see LoadOptions::_maxUnknownLineSamples).  Nothing is printed if there weren't
+    any.
+Parameters:
+    filePath    For the message.
+    state       After parsing the whole file.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static void ReportUnknownLines(const std::string &filePath, const ObjParseState &state)
+{
+    if (state._lineCounts._unknown == 0)
+    {
+        return;
+    }
+
+    cout << "File '" << filePath << "' has " << state._lineCounts._unknown
+        << " lines with an unknown header (ignored)";
+    if (state._unknownLineSamples.empty())
+    {
+        cout << endl;
+        return;
+    }
+
+    cout << "; the first " << state._unknownLineSamples.size() << ":" << endl;
+    for (size_t sampleIndex = 0; sampleIndex < state._unknownLineSamples.size(); sampleIndex++)
+    {
+        cout << "    '" << state._unknownLineSamples[sampleIndex] << "'" << endl;
+    }
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Summarizes the unknown lines (see ReportUnknownLines(...)) and the faces and lines that
+    came before the first object, then complains if any face or line in the file referred to a
+    position or normal that doesn't exist.  Such a file is rejected outright rather than drawn
+    with garbage vertices.
+
+    Note: Records before the first object are only reported (once, not once per record).  They
+    are ignored, so they don't make the file bad.
+Parameters:
+    filePath    For the error message.
+    state       After parsing the whole file.
+Returns:
+    True if there were no bad records, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static bool AllRecordsWereGood(const std::string &filePath, const ObjParseState &state)
+{
+    ReportUnknownLines(filePath, state);
+    if (state._numRecordsWithoutObject > 0)
+    {
+        cout << "File '" << filePath << "' has " << state._numRecordsWithoutObject
+            << " faces or lines before the first object (ignored)" << endl;
+    }
+    if (state._numBadRecords == 0)
+    {
+        return true;
+    }
+
+    cout << "File '" << filePath << "' has " << state._numBadRecords
+        << " faces or lines that refer to positions or normals that don't exist" << endl;
+    return false;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    The part of LoadObj(...) and LoadObjFromMemory(...) that only needs the text: parses it on
+    one or more threads, checks the records, and welds if asked.
+Parameters:
+    textBegin       Pointer to the first character of the .obj text.
+    textEnd         Pointer to one past the last character of the .obj text.
+    sourceName      The file path (or some other name) for error messages.
+    options         See LoadOptions.
+    state           Where the parsed data goes.
+    prescanSecondsOut   Gets how long the counting pass took.  With several threads, the
+                        slowest worker's.
+Returns:
+    True if the text was parsed and every record was good, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static bool ParseObjTextWithOptions(const char *textBegin, const char *textEnd,
+    const std::string &sourceName, const BlenderLoad::LoadOptions &options,
+    ObjParseState *state, double *prescanSecondsOut)
+{
+    unsigned int numThreads = options._numThreads;
+    if (numThreads == 0)
+    {
+        // may return 0 if it can't tell
+        numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    bool success = false;
+    *prescanSecondsOut = 0.0;
+    if (numThreads > 1)
+    {
+        success = ParseObjTextMultithreaded(textBegin, textEnd, sourceName, numThreads,
+            options._preallocate, state, prescanSecondsOut);
+    }
+    else
+    {
+        success = ParseObjText(textBegin, textEnd, sourceName, options._preallocate, state,
+            prescanSecondsOut);
+    }
 
+    success = success && AllRecordsWereGood(sourceName, *state);
+    if (success && options._weldVertices)
+    {
+        WeldGeometry(state);
+    }
+    return success;
+}
 
 /*-----------------------------------------------------------------------------------------------
 Description:
-    Loads a set of vertices from a .obj file.  
-    
-    Note: Blender3D has the option, when exporting the scene, to use +Y as "up" or +Z as "up".  
-    The .obj file itself says nothing about the matter.  This loading function will assume that 
+    Loads a set of vertices from a .obj file.
+
+    Note: Blender3D has the option, when exporting the scene, to use +Y as "up" or +Z as "up".
+    The .obj file itself says nothing about the matter.  This loading function will assume that
     +Z is set as up since that is the way that OpenGL does it in 3D.
 
-    Also Note: The .obj file does not specify any transform, so all the vertices and normals in 
-    a .obj file are "as is".  Since this demo operates in window space (X and Y on the range 
-    [-1,+1]) and on the depth range 0 to -1, the objects in the file must be constrained within 
+    Also Note: The .obj file does not specify any transform, so all the vertices and normals in
+    a .obj file are "as is".  Since this demo operates in window space (X and Y on the range
+    [-1,+1]) and on the depth range 0 to -1, the objects in the file must be constrained within
     those bounds.
 
-    
-Parameters: 
+    Also Also Note: By default, the file is memory-mapped and parsed in place, so there are no
+    per-line string allocations.  The std::getline(...) path can still be selected through the
+    options for comparison.  Multithreaded parsing requires the memory-mapped path, and so does
+    the binary cache: unless it is turned off, the results are saved next to the .obj file and
+    later loads of the same (unchanged) .obj file read that instead (see GeometryCache).
+
+    Also Also Also Note: A file that ends in ".gz" or ".zst" is decompressed as it is parsed
+    (see ParseCompressedObjText(...)), if the loader was built with support for it (see
+    DecompressionStream).  The compressed file is always memory-mapped, and it is what the
+    binary cache is checked against.  LoadOptions::_numThreads and LoadOptions::_preallocate
+    are ignored for these.
+
+Parameters:
     filePath    The path to the .obj file
-    putDataHere An empty collection (will be cleared on function start) of GeometryData 
-                structures by name. The vertices and normals will be extracted from the file and 
-                the resulting vertex objects will be jammed into here.
-Returns:    
+    putDataHere An empty collection (will be cleared on function start) of GeometryData
+                structures by name. The vertices and normals will be extracted from the file and
+                the resulting vertex objects will be jammed into here, in the order that the
+                objects first show up in the file.
+    options     Selects how the file is read.
+    stats       Optional.  If not null, gets the number of bytes parsed, how long it took, and
+                the peak memory use.
+Returns:
     True if the function succeeded, otherwise false.
 Exception:  Safe
 Creator:    John Cox (2-13-2016)
 -----------------------------------------------------------------------------------------------*/
-bool BlenderLoad::LoadObj(const std::string &filePath, GEOMETRY_DATA_BY_NAME *putDataHere)
+bool BlenderLoad::LoadObj(const std::string &filePath, GEOMETRY_DATA_BY_NAME *putDataHere,
+    const LoadOptions &options, LoadStatistics *stats)
 {
-    std::ifstream fileStream(filePath, std::ios::in);
-    if (!fileStream.is_open())
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    // the binary cache is written from (and read back into) the whole collection, so it must
+    // hold only this file's objects
+    putDataHere->Clear();
+
+    ObjParseState state(putDataHere);
+    state._maxUnknownLineSamples = options._maxUnknownLineSamples;
+    state._stitchLines = options._stitchLines;
+    CompressionFormat compression = CompressionFormatForPath(filePath);
+    unsigned long long bytesParsed = 0;
+    unsigned long long compressedBytes = 0;
+    double prescanSeconds = 0.0;
+    double cacheSeconds = 0.0;
+    bool success = false;
+    if (options._useMemoryMap || compression != COMPRESSION_NONE)
+    {
+        MemoryMappedFile objFile;
+        if (!objFile.Open(filePath))
+        {
+            cout << "Could not find the .obj file: " << filePath << endl;
+            return false;
+        }
+
+        bytesParsed = objFile.Size();
+        compressedBytes = (compression != COMPRESSION_NONE) ? objFile.Size() : 0;
+
+        // a warm start only has to hash the text, not parse it
+        std::string cachePath = GeometryCache::CachePathFor(filePath);
+        unsigned long long objHash = 0;
+        if (options._useBinaryCache)
+        {
+            std::chrono::steady_clock::time_point cacheStartTime =
+                std::chrono::steady_clock::now();
+            objHash = GeometryCache::HashBytes(objFile.Data(), objFile.Size());
+            bool cacheWasRead = GeometryCache::Read(cachePath, objFile.Size(), objHash,
+                options._weldVertices, options._weldVertices && options._stitchLines,
+                putDataHere);
+            cacheSeconds = SecondsSince(cacheStartTime);
+            if (cacheWasRead)
+            {
+                if (stats != 0)
+                {
+                    FillLoadStatistics(startTime, bytesParsed, 0.0, true, 0, stats);
+                    stats->_compressedBytes = compressedBytes;
+                    stats->_cacheSeconds = cacheSeconds;
+                    stats->_numObjects = putDataHere->Size();
+                    CollectObjectStatistics(*putDataHere, options, stats);
+                }
+                return true;
+            }
+        }
+
+        if (compression != COMPRESSION_NONE)
+        {
+            success = ParseCompressedObjText(objFile.Data(), objFile.Size(), compression,
+                filePath, &state, &bytesParsed);
+            success = success && AllRecordsWereGood(filePath, state);
+            if (success && options._weldVertices)
+            {
+                WeldGeometry(&state);
+            }
+        }
+        else
+        {
+            success = ParseObjTextWithOptions(objFile.Data(),
+                objFile.Data() + objFile.Size(), filePath, options, &state, &prescanSeconds);
+        }
+
+        if (success && options._useBinaryCache)
+        {
+            std::chrono::steady_clock::time_point cacheStartTime =
+                std::chrono::steady_clock::now();
+            if (!GeometryCache::Write(cachePath, objFile.Size(), objHash,
+                options._weldVertices, options._weldVertices && options._stitchLines,
+                *putDataHere))
+            {
+                // not fatal; the next run will just parse the text again
+                cout << "Could not write the geometry cache: " << cachePath << endl;
+            }
+            cacheSeconds += SecondsSince(cacheStartTime);
+        }
+    }
+    else
+    {
+        success = ParseObjFileStream(filePath, &state, &bytesParsed);
+        success = success && AllRecordsWereGood(filePath, state);
+        if (success && options._weldVertices)
+        {
+            WeldGeometry(&state);
+        }
+    }
+
+    if (stats != 0)
+    {
+        FillLoadStatistics(startTime, bytesParsed, prescanSeconds, false, &state, stats);
+        stats->_compressedBytes = compressedBytes;
+        stats->_cacheSeconds = cacheSeconds;
+        if (success)
+        {
+            CollectObjectStatistics(*putDataHere, options, stats);
+        }
+    }
+
+    return success;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Loads .obj text that is already in memory (from a pack file, decompressed, embedded in the
+    program, etc.) exactly like LoadObj(...) loads a file.  The text is parsed in place; it is
+    not copied, and it doesn't need to be null-terminated.
+
+    Note: There is no file to put a binary cache next to, so LoadOptions::_useBinaryCache is
+    ignored, and so is LoadOptions::_useMemoryMap (the text is already in memory).
+Parameters:
+    text        Pointer to the first character of the .obj text.  Must stay valid until this
+                function returns, but not after.
+    numBytes    The length of the text.
+    putDataHere Same as for LoadObj(...).
+    options     Same as for LoadObj(...), except as noted above.
+    stats       Same as for LoadObj(...).
+Returns:
+    True if the function succeeded, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool BlenderLoad::LoadObjFromMemory(const char *text, size_t numBytes,
+    GEOMETRY_DATA_BY_NAME *putDataHere, const LoadOptions &options, LoadStatistics *stats)
+{
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    putDataHere->Clear();
+
+    ObjParseState state(putDataHere);
+    state._maxUnknownLineSamples = options._maxUnknownLineSamples;
+    state._stitchLines = options._stitchLines;
+    double prescanSeconds = 0.0;
+    bool success = ParseObjTextWithOptions(text, text + numBytes, "(in-memory .obj)", options,
+        &state, &prescanSeconds);
+
+    if (stats != 0)
+    {
+        FillLoadStatistics(startTime, numBytes, prescanSeconds, false, &state, stats);
+        if (success)
+        {
+            CollectObjectStatistics(*putDataHere, options, stats);
+        }
+    }
+
+    return success;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Loads a .obj file like LoadObj(...), but hands each object to the callback as soon as it
+    is finished (when the next "o" line or the end of the file shows up) instead of collecting
+    all of them.  The caller can start uploading or processing an object while the rest of the
+    file is still being parsed, and only one object's vertices are held by the loader at a
+    time.
+
+    Note: The positions and normals still have to be kept for the whole file because Blender
+    numbers them across the whole file (see ParseObjTextMultithreaded(...)).
+
+    Also Note: Objects are delivered one "o" block at a time and in file order.  If a name
+    shows up more than once, the callback gets it more than once, whereas LoadObj(...) would
+    merge the blocks.
+
+    Also Also Note: This always parses on the calling thread (the callback is called on that
+    thread too), and it doesn't use the binary cache.  LoadOptions::_numThreads and
+    LoadOptions::_useBinaryCache are ignored.  Compressed files are handled as in LoadObj(...).
+Parameters:
+    filePath        The path to the .obj file
+    onObjectLoaded  Called once per object with the object's name and its finished
+                    GeometryData.  The callback may take the data with std::move(...).
+    options         Selects how the file is read.
+    stats           Optional.  Same as for LoadObj(...).
+Returns:
+    True if the function succeeded, otherwise false.  If false, objects that were delivered
+    before the problem was found may be missing their bad faces and lines.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool BlenderLoad::LoadObjStreaming(const std::string &filePath,
+    const OBJECT_CALLBACK &onObjectLoaded, const LoadOptions &options, LoadStatistics *stats)
+{
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    std::vector<WeldStatistics> weldStats;
+    std::vector<QuantizationStatistics> quantizationStats;
+    ObjParseState state(&onObjectLoaded);
+    state._maxUnknownLineSamples = options._maxUnknownLineSamples;
+    state._stitchLines = options._stitchLines;
+    state._weldStreamedObjects = options._weldVertices;
+    state._streamedWeldStats = &weldStats;
+    if (options._quantizeVertices)
+    {
+        state._streamedQuantizationStats = &quantizationStats;
+    }
+
+    CompressionFormat compression = CompressionFormatForPath(filePath);
+    unsigned long long bytesParsed = 0;
+    unsigned long long compressedBytes = 0;
+    double prescanSeconds = 0.0;
+    bool success = false;
+    if (options._useMemoryMap || compression != COMPRESSION_NONE)
+    {
+        MemoryMappedFile objFile;
+        if (!objFile.Open(filePath))
+        {
+            cout << "Could not find the .obj file: " << filePath << endl;
+            return false;
+        }
+
+        if (compression != COMPRESSION_NONE)
+        {
+            compressedBytes = objFile.Size();
+            success = ParseCompressedObjText(objFile.Data(), objFile.Size(), compression,
+                filePath, &state, &bytesParsed);
+        }
+        else
+        {
+            bytesParsed = objFile.Size();
+            success = ParseObjText(objFile.Data(), objFile.Data() + objFile.Size(), filePath,
+                options._preallocate, &state, &prescanSeconds);
+        }
+    }
+    else
+    {
+        success = ParseObjFileStream(filePath, &state, &bytesParsed);
+    }
+
+    // there is no "o" line after the last object
+    FinishStreamedObject(&state);
+    success = success && AllRecordsWereGood(filePath, state);
+
+    if (stats != 0)
+    {
+        FillLoadStatistics(startTime, bytesParsed, prescanSeconds, false, &state, stats);
+        stats->_compressedBytes = compressedBytes;
+        stats->_weldStats.swap(weldStats);
+        stats->_quantizationStats.swap(quantizationStats);
+    }
+
+    return success;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Finds every "o" block in a .obj file without parsing any of the data in it.  This is much
+    quicker than loading the file, and the result can be used to list the objects in a scene or
+    to pick some of them for LoadObjSelected(...).
+Parameters:
+    filePath        The path to the .obj file
+    putIndexHere    Gets one entry per "o" block, in file order.
+    useIndexCache   True: reuse (or create) the index file next to the .obj file (see
+                    GeometryCache).  It is invalidated the same way as the binary cache.
+Returns:
+    True if the function succeeded, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool BlenderLoad::GetObjectIndex(const std::string &filePath, OBJECT_INDEX *putIndexHere,
+    bool useIndexCache)
+{
+    MemoryMappedFile objFile;
+    if (!objFile.Open(filePath))
     {
         cout << "Could not find the .obj file: " << filePath << endl;
         return false;
     }
 
-    std::string line;
-    std::getline(fileStream, line);
-    size_t posOfSubstring = line.find("OBJ");
-    if (posOfSubstring == -1)
+    return ReadOrBuildObjectIndex(objFile, filePath, useIndexCache, putIndexHere);
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Loads only the named objects from a .obj file.  The object index (see GetObjectIndex(...))
+    says where each object's "o" block is, so only those byte ranges are parsed and the rest
+    of the file is never looked at (except to hash it if the index file is used).
+
+    Note: The output is the same as those objects' output from LoadObj(...).  If a name shows up
+    more than once in the file, all of its blocks are loaded and merged, just like LoadObj(...)
+    does.
+
+    Also Note: The file is always memory-mapped, the blocks are parsed on the calling thread,
+    and the binary geometry cache is not used (it holds the whole file).
+    LoadOptions::_useMemoryMap and LoadOptions::_numThreads are ignored, and
+    LoadOptions::_useBinaryCache only decides whether the index file is used.
+Parameters:
+    filePath        The path to the .obj file
+    objectNames     The objects to load.
+    putDataHere     Same as for LoadObj(...), but only gets the named objects.
+    options         See the note above.
+    stats           Optional.  Same as for LoadObj(...), but only counts the bytes in the
+                    selected blocks.
+Returns:
+    True if every named object was found and loaded, otherwise false.  Objects that were found
+    are loaded even if some names were not.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool BlenderLoad::LoadObjSelected(const std::string &filePath,
+    const std::vector<std::string> &objectNames, GEOMETRY_DATA_BY_NAME *putDataHere,
+    const LoadOptions &options, LoadStatistics *stats)
+{
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    putDataHere->Clear();
+
+    MemoryMappedFile objFile;
+    if (!objFile.Open(filePath))
     {
-        cout << "File '" << filePath << "' is not an OBJ file" << endl;
+        cout << "Could not find the .obj file: " << filePath << endl;
         return false;
     }
 
-    // "www.blender.org"
-    std::getline(fileStream, line);
-
-    // material file (don't care in this demo)
-    std::getline(fileStream, line);
+    OBJECT_INDEX objectIndex;
+    if (!ReadOrBuildObjectIndex(objFile, filePath, options._useBinaryCache, &objectIndex))
+    {
+        return false;
+    }
 
+    // the names are looked up once per block, so sort them once
+    std::vector<std::string> sortedNames(objectNames);
+    std::sort(sortedNames.begin(), sortedNames.end());
+    sortedNames.erase(std::unique(sortedNames.begin(), sortedNames.end()), sortedNames.end());
+    std::vector<bool> nameWasFound(sortedNames.size(), false);
 
-    std::vector<glm::vec3> vertPositions;
-    //std::vector<glm::vec3> vertTextureCoord;    // not supported (yet)
-    std::vector<glm::vec3> vertNormals;
-
-    // parse it line by line
-    // Note: Each line of data is preceded by a 1-char symbol.
-    // Also Note: It is possible for a single object to have both an "f" and an "l", but if this 
-    // has happened, this means that there is a mix of 2D and 3D vertices and something has gone 
-    // wrong when manipulating the object in Blender.  For the sake of this demo, assume that if 
-    // the object specifies "f" then it has faces and if it specifies "l" then it has lines.
-    std::string lineHeaderObjectName("o ");
-    std::string lineHeaderVertexPosition("v ");
-    std::string lineHeaderVertexNormal("vn ");
-    std::string lineHeaderFace("f ");
-    std::string lineHeaderLine("l ");
-    std::string lineHeaderUseMaterial("usemtl ");
-    std::string lineHeaderSmoothShading("s ");
-
-    GeometryData *geometryData = 0;
-    while (std::getline(fileStream, line))
+    ObjParseState state(putDataHere);
+    state._maxUnknownLineSamples = options._maxUnknownLineSamples;
+    state._stitchLines = options._stitchLines;
+    unsigned long long bytesParsed = 0;
+    double prescanSeconds = 0.0;
+    for (size_t entryIndex = 0; entryIndex < objectIndex.size(); entryIndex++)
     {
-        if (line.substr(0, lineHeaderObjectName.length()) == lineHeaderObjectName)
-        {
-            // new object
-            
-            // extract from the end of the head until the end of the line
-            std::string objectName = line.substr(lineHeaderObjectName.length());
-            
-            // make a new GeometryData object and stuff any face/line data into there
-            putDataHere->insert(GEOMETRY_NAME_PAIR(objectName, GeometryData()));
-            geometryData = &(putDataHere->find(objectName)->second);
-
-            // do NOT clear out the vertex position and normal collections because Blender OBJ 
-            // files treat vertex values as being in a single, large collection 
-            // Ex: Obj 1 is a flat plane and has a single vertex normal value.  The face 
-            // description will use normal index 1.
-            // Ex: Obj 2 is a bent plane with 2 vertex normals.  The face descriptions will use 
-            // normal indices 2 and 3.  They don't reset at 1.
-        }
-        else if (line.substr(0, lineHeaderVertexPosition.length()) == lineHeaderVertexPosition)
-        {
-            // as stated in the function description, expecting +Z to be up
-            float x;
-            float y;
-            float z;
-            std::string subStr = line.substr(lineHeaderVertexPosition.length());
-            const char *readBuffer = subStr.c_str();
-            sscanf(readBuffer, "%f %f %f", &x, &y, &z);
-            vertPositions.push_back(glm::vec3(x, y, z));
-        }
-        else if (line.substr(0, lineHeaderVertexNormal.length()) == lineHeaderVertexNormal)
-        {
-            float x;
-            float y;
-            float z;
-            std::string subStr = line.substr(lineHeaderVertexPosition.length());
-            const char *readBuffer = subStr.c_str();
-            sscanf(readBuffer, "%f %f %f", &x, &y, &z);
-            vertNormals.push_back(glm::vec3(x, y, z));
-        }
-        else if (line.substr(0, lineHeaderLine.length()) == lineHeaderLine)
-        {
-            // data comes in lines
-            // Note: I am assuming (for demo) that it only has lines.  It is possible for a 
-            // shape to have both lines and faces, but that is when someone adds an edge between 
-            // two vertices without merging the vertices.  For the sake of this demo, just 
-            // assume that, if there is line in the shape's data, then the shape should be drawn 
-            // with lines only.
-            geometryData->_drawStyle = GL_LINES;
-
-            // 2D lines in Blender only have positions, not normals nor texture coordinates
-            unsigned short p1Index = 0;
-            unsigned short p2Index = 0;
-
-            // the 'h' indicates the reading of a short integer
-            // Note: http://www.cprogramming.com/tutorial/printf-format-strings.html
-            std::string subStr = line.substr(lineHeaderLine.length());
-            const char *readBuffer = subStr.c_str();
-            sscanf(readBuffer, "%hd %hd", &p1Index, &p2Index);
-
-            // create the vertex objects and put them into the geometry data
-            // Note: Indices for lines begin at 1 (not 0).
-            // Also Note: +Z is up, and this is 2D, so I only need the X and Y out of the 
-            // position, and thus I can jam the vec3 position into a vec2 and the constructor 
-            // will cut off the Z.
-            glm::vec2 p1(vertPositions[p1Index - 1]);
-            glm::vec2 p2(vertPositions[p2Index - 1]);
-
-            // remember that Blender3D does not specify normals for simple lines, so just stick 
-            // in an empty normal.
-            MyVertex v1(p1, glm::vec2());
-            MyVertex v2(p2, glm::vec2());
-            geometryData->_verts.push_back(v1);
-            geometryData->_verts.push_back(v2);
-        }
-        else if (line.substr(0, lineHeaderFace.length()) == lineHeaderFace)
-        {
-            // data comes in quads (4 vertexes)
-            // Note: I am assuming (for demo) that it only has quads, but quads have been 
-            // deprecated for years, so I need to turn the quads into triangles.
-            geometryData->_drawStyle = GL_TRIANGLES;
-
-            // 'p' = position, 't' texture coordinate, 'n' = normal
-            // Note: Texture coordinates not available yet, but handling them here anyway.
-            unsigned short p1Index = 0, t1Index = 0, n1Index = 0;
-            unsigned short p2Index = 0, t2Index = 0, n2Index = 0;
-            unsigned short p3Index = 0, t3Index = 0, n3Index = 0;
-            unsigned short p4Index = 0, t4Index = 0, n4Index = 0;
-
-            // the 'h' indicates the reading of a short integer
-            // Note: http://www.cprogramming.com/tutorial/printf-format-strings.html
-            std::string subStr = line.substr(lineHeaderFace.length());
-            const char *readBuffer = subStr.c_str();
-            sscanf_s(readBuffer, "%hd/%hd/%hd %hd/%hd/%hd %hd/%hd/%hd %hd/%hd/%hd",
-                &p1Index, &t1Index, &n1Index,
-                &p2Index, &t2Index, &n2Index,
-                &p3Index, &t3Index, &n3Index,
-                &p4Index, &t4Index, &n4Index);
-
-            // there is always position and normal, but not always texture
-            // Note: The face indices begin at 1 (not 0), so if the index is 0, then there is no 
-            // value.
-            if (t1Index == 0 || t2Index == 0 || t3Index == 0 || t4Index == 0)
-            {
-                // no texture coordinates, so run the parse again
-                sscanf(readBuffer, "%hd//%hd %hd//%hd %hd//%hd %hd//%hd",
-                    &p1Index, &n1Index,
-                    &p2Index, &n2Index,
-                    &p3Index, &n3Index,
-                    &p4Index, &n4Index);
-            }
-
-            // make triangles from the quad and put the data into the geometry structure
-            // Note: For the sake of the this demo, which is in 2D, ignore the Z component.
-            glm::vec2 p1(vertPositions[p1Index - 1]);
-            glm::vec2 p2(vertPositions[p2Index - 1]);
-            glm::vec2 p3(vertPositions[p3Index - 1]);
-            glm::vec2 p4(vertPositions[p4Index - 1]);
-            glm::vec2 n1(vertNormals[n1Index - 1]);
-            glm::vec2 n2(vertNormals[n2Index - 1]);
-            glm::vec2 n3(vertNormals[n3Index - 1]);
-            glm::vec2 n4(vertNormals[n4Index - 1]);
-
-            // these normals are meant for 3D and thus have a Z component, but right now that is 
-            // being ignored, so the surface normals will not matter at render time
-            MyVertex v1(p1, n1);
-            MyVertex v2(p2, n2);
-            MyVertex v3(p3, n3);
-            MyVertex v4(p4, n4);
-            
-            // Note: Triangle 1 is v1, v2, v3.  
-            geometryData->_verts.push_back(v1);
-            geometryData->_verts.push_back(v2);
-            geometryData->_verts.push_back(v3);
-            
-            // Note: Triangle 2 is v3, v4, v1.
-            geometryData->_verts.push_back(v3);
-            geometryData->_verts.push_back(v4);
-            geometryData->_verts.push_back(v1);
-
-            // doing a triangle, so 
-        }
-        else if (line.substr(0, lineHeaderUseMaterial.length()) == lineHeaderUseMaterial)
-        {
-            // materials ignored in this demo
-        }
-        else if (line.substr(0, lineHeaderSmoothShading.length()) == lineHeaderSmoothShading)
-        {
-            // smooth shading ignored in this demo
+        const ObjectIndexEntry &entry = objectIndex[entryIndex];
+        auto nameItr = std::lower_bound(sortedNames.begin(), sortedNames.end(), entry._name);
+        if (nameItr == sortedNames.end() || *nameItr != entry._name)
+        {
+            continue;
         }
-        else
+        nameWasFound[nameItr - sortedNames.begin()] = true;
+
+        const char *blockBegin = objFile.Data() + entry._textBegin;
+        const char *blockEnd = objFile.Data() + entry._textEnd;
+        double blockPrescanSeconds = 0.0;
+        ParseObjBlock(blockBegin, blockEnd, entry, options._preallocate, &state,
+            &blockPrescanSeconds);
+        bytesParsed += entry._textEnd - entry._textBegin;
+        prescanSeconds += blockPrescanSeconds;
+    }
+
+    bool success = AllRecordsWereGood(filePath, state);
+    if (!success)
+    {
+        cout << "Note: Objects can only be loaded on their own if they don't use positions or "
+            "normals from other objects" << endl;
+    }
+
+    for (size_t nameIndex = 0; nameIndex < sortedNames.size(); nameIndex++)
+    {
+        if (!nameWasFound[nameIndex])
         {
-            // ??unknown header??
-            cout << "unknown line header for line '" << line << "'" << endl;
-            // ??return false??
+            cout << "Object '" << sortedNames[nameIndex] << "' is not in '" << filePath << "'"
+                << endl;
+            success = false;
         }
     }
 
-    // all went well
-    return true;
+    if (options._weldVertices)
+    {
+        WeldGeometry(&state);
+    }
+
+    if (stats != 0)
+    {
+        FillLoadStatistics(startTime, bytesParsed, prescanSeconds, false, &state, stats);
+        CollectObjectStatistics(*putDataHere, options, stats);
+    }
+
+    return success;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Finds a name for an object that is being added to a collection that may already have an
+    object by that name.  A name that is taken gets a ".001"-style suffix, like Blender does,
+    rather than replacing or being merged into the existing object.
+Parameters:
+    objectName      The name that the object would like to have.
+    existingObjects The collection that it will go into.
+Returns:
+    objectName if it is free, otherwise objectName with the first free suffix.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+std::string BlenderLoad::UniqueObjectName(const std::string &objectName,
+    const GEOMETRY_DATA_BY_NAME &existingObjects)
+{
+    std::string uniqueName = objectName;
+    char suffix[16];
+    for (unsigned int suffixNumber = 1; existingObjects.Contains(uniqueName); suffixNumber++)
+    {
+        snprintf(suffix, sizeof(suffix), ".%03u", suffixNumber);
+        uniqueName = objectName + suffix;
+    }
+    return uniqueName;
 }
@@ -1,9 +1,10 @@
 #pragma once
 
 #include <string>
-#include <map>
 #include <vector>
+#include <functional>
 #include "GeometryData.h"
+#include "GeometryRegistry.h"
 
 
 /*-----------------------------------------------------------------------------------------------
@@ -12,22 +13,230 @@ Description:
     collection.  It is the responsibility of the user to then take this data and store it in 
     buffer objects as they see fit.
 
-    Note: When defining faces and lines, almost every single face-normal pair is unique.  This 
-    means that there is little benefit to using element arrays, which were created to allow 
-    re-use of existing vertices.  Instead, I will simply use the vertex arrays.
+    Note: By default every face and line is expanded into its own vertices and drawn with the 
+    vertex arrays.  Each quad turns into 6 vertices though, and the corners inside a filled 
+    shape are shared by several quads, so LoadOptions::_weldVertices can collapse the 
+    duplicates and produce element arrays instead (see VertexWeld.h).
 Creator:    John Cox (10-23-2016)
 -----------------------------------------------------------------------------------------------*/
 class BlenderLoad
 {
 public:
-    // Note:
-    // - std::string    The name of the object given by the file.
-    // - GeometryData   The draw style (lines or triangles) and the vertex data.
-    typedef std::map<std::string, GeometryData> GEOMETRY_DATA_BY_NAME;
+    // Note: Each object has the name given by the file, the draw style (lines or triangles),
+    // and the vertex data.  Objects are in the order that they first show up in the file.
+    typedef GeometryRegistry GEOMETRY_DATA_BY_NAME;
 
-    static bool LoadObj(const std::string &filePath, GEOMETRY_DATA_BY_NAME *putDataHere);
+    // for LoadObjStreaming(...)
+    // Note: The GeometryData is only valid during the call, but the callback may move it out.
+    typedef std::function<void(const std::string &objectName, GeometryData *geometryData)>
+        OBJECT_CALLBACK;
 
-private:
-    // for use in pushing a value onto the map
-    typedef std::pair<std::string, GeometryData> GEOMETRY_NAME_PAIR;
+    /*-------------------------------------------------------------------------------------------
+    Description:
+        Selects how LoadObj(...) gets at the file's text.  The defaults are the fast path.
+    -------------------------------------------------------------------------------------------*/
+    struct LoadOptions
+    {
+        LoadOptions();
+
+        // true: map the file into memory and tokenize it in place (no per-line allocations)
+        // false: the original std::ifstream + std::getline path (kept for comparison)
+        bool _useMemoryMap;
+
+        // 1: parse on the calling thread
+        // 0: one thread per hardware thread
+        // Note: Only used with the memory-mapped path.  The output is identical either way.
+        unsigned int _numThreads;
+
+        // true: reuse (or create) a binary cache of the results next to the .obj file
+        // Note: Only used with the memory-mapped path.  See GeometryCache.
+        bool _useBinaryCache;
+
+        // true: count the records in a quick first pass over the text so that the position,
+        // normal, and vertex collections can be allocated at their exact sizes up front
+        // false: let the collections grow as records are parsed (more reallocations, and up to
+        // twice the memory while they are growing)
+        // Note: Only used with the memory-mapped path.  The output is identical either way.
+        bool _preallocate;
+
+        // true: collapse identical vertices in each object and fill out GeometryData::_indices
+        // false: one vertex per face/line corner, no indices
+        bool _weldVertices;
+
+        // true: chain the segments of each line object into strips (see LineStitch.h), which
+        // are drawn as GL_LINE_STRIP with primitive restart
+        // false: line objects stay GL_LINES
+        // Note: Only used if _weldVertices is true, since stitching works on welded indices.
+        bool _stitchLines;
+
+        // true: the caller is going to upload with SharedGeometryBuffer::Init(true) (see
+        // Vertex2DQuantized), so measure how far off each object will be
+        // false: don't bother
+        // Note: This doesn't change the output; quantization only happens on upload.
+        bool _quantizeVertices;
+
+        // true: objects that are only a translated copy of an earlier object become instances
+        // of it (see TranslatedCopies.h) as they are put into the scene
+        // false: every object keeps its own vertices
+        // Note: Only used by AsyncSceneLoader.  The loader's own output is unchanged; see
+        // InstanceTranslatedCopies(...) to do the same to it.
+        bool _instanceCopies;
+
+        // lines that the loader doesn't recognize are counted and reported once at the end of
+        // the load; this is how many of them are kept (and printed) as examples
+        // Note: 0 means just the count.
+        size_t _maxUnknownLineSamples;
+    };
+
+    /*-------------------------------------------------------------------------------------------
+    Description:
+        How much welding saved for a single object.  The "before" numbers are what the 
+        unwelded vertices would have cost.
+    -------------------------------------------------------------------------------------------*/
+    struct WeldStatistics
+    {
+        std::string _objectName;
+        size_t _vertsBefore;
+        size_t _vertsAfter;
+
+        // vertex buffer + element buffer, as uploaded (so with 16-bit indices if those fit)
+        // Note: Every draw reads through these buffers, so this is also a rough measure of the
+        // vertex fetch bandwidth.
+        size_t _bytesBefore;
+        size_t _bytesAfter;
+    };
+
+    /*-------------------------------------------------------------------------------------------
+    Description:
+        How far the quantized vertices (see Vertex2DQuantized) of a single object are from the
+        loaded ones, as the vertex shader will see them.
+    -------------------------------------------------------------------------------------------*/
+    struct QuantizationStatistics
+    {
+        std::string _objectName;
+
+        // the largest difference in any one component, in window space for the position
+        float _maxPositionError;
+        float _maxNormalError;
+    };
+
+    /*-------------------------------------------------------------------------------------------
+    Description:
+        How many lines of each kind were read.  The header lines that Blender writes at the
+        top of every file are skipped, so they are not counted.
+    -------------------------------------------------------------------------------------------*/
+    struct LineCounts
+    {
+        LineCounts();
+        void Add(const LineCounts &other);
+        unsigned long long Total() const;
+
+        unsigned long long _objectNames;    // "o"
+        unsigned long long _positions;      // "v"
+        unsigned long long _normals;        // "vn"
+        unsigned long long _lines;          // "l"
+        unsigned long long _faces;          // "f"
+        unsigned long long _useMaterials;   // "usemtl"
+        unsigned long long _smoothShading;  // "s"
+
+        // "#" and blank lines
+        unsigned long long _comments;
+
+        // anything else ("g", "mtllib" past the header, etc.), which is ignored
+        unsigned long long _unknown;
+    };
+
+    /*-------------------------------------------------------------------------------------------
+    Description:
+        Filled out by LoadObj(...) so that the caller can keep track of loader throughput.
+    -------------------------------------------------------------------------------------------*/
+    struct LoadStatistics
+    {
+        LoadStatistics();
+        double MegabytesPerSecond() const;
+
+        // the size of the .obj text; if it came out of the binary cache, the text was only
+        // hashed, not parsed (see MegabytesPerSecond())
+        unsigned long long _bytesParsed;
+        double _parseSeconds;
+
+        // the size of the file on disk if it was compressed (_bytesParsed is the size of the
+        // decompressed text), otherwise 0
+        unsigned long long _compressedBytes;
+
+        // true if the geometry came out of the binary cache instead of the text
+        bool _loadedFromCache;
+
+        // how much of _parseSeconds was spent on the counting pass (see
+        // LoadOptions::_preallocate), on welding, and on hashing the file and reading or
+        // writing the binary cache
+        // Note: The rest went to opening the file and parsing the text.
+        // Also Note: When several threads parse, each counts its own piece of the file at the
+        // same time, so _prescanSeconds is the slowest one's count.
+        double _prescanSeconds;
+        double _weldSeconds;
+        double _cacheSeconds;
+
+        // what was in the text, and how many vertices its faces and lines turned into (before
+        // welding, if any)
+        // Note: All zero (and empty) if the geometry came out of the binary cache.
+        LineCounts _lineCounts;
+        std::vector<std::string> _unknownLineSamples;
+        unsigned long long _numVertsEmitted;
+
+        // how many objects came out
+        size_t _numObjects;
+
+        // the process' peak physical memory after the load (see ProcessMemory.h)
+        unsigned long long _peakResidentBytes;
+
+        // one per object, in the same order as the output collection
+        // Note: Empty unless LoadOptions::_weldVertices was true.
+        std::vector<WeldStatistics> _weldStats;
+
+        // one per object, in the same order as the output collection
+        // Note: Empty unless LoadOptions::_quantizeVertices was true.
+        std::vector<QuantizationStatistics> _quantizationStats;
+    };
+
+    /*-------------------------------------------------------------------------------------------
+    Description:
+        Where one "o" block sits in a .obj file (see GetObjectIndex(...)).  Blender numbers
+        positions and normals across the whole file, so the number of each that come before
+        the block is kept too.  With those, the block's indices can be resolved without
+        reading anything else in the file.
+    -------------------------------------------------------------------------------------------*/
+    struct ObjectIndexEntry
+    {
+        std::string _name;
+
+        // byte offsets into the file: the start of the "o" line and one past the end of the
+        // block's last line
+        unsigned long long _textBegin;
+        unsigned long long _textEnd;
+
+        unsigned long long _positionsBefore;
+        unsigned long long _normalsBefore;
+    };
+
+    // one entry per "o" block, in file order
+    // Note: A name that shows up more than once gets more than one entry.
+    typedef std::vector<ObjectIndexEntry> OBJECT_INDEX;
+
+    static bool LoadObj(const std::string &filePath, GEOMETRY_DATA_BY_NAME *putDataHere,
+        const LoadOptions &options = LoadOptions(), LoadStatistics *stats = 0);
+    static bool LoadObjFromMemory(const char *text, size_t numBytes,
+        GEOMETRY_DATA_BY_NAME *putDataHere, const LoadOptions &options = LoadOptions(),
+        LoadStatistics *stats = 0);
+    static bool LoadObjStreaming(const std::string &filePath,
+        const OBJECT_CALLBACK &onObjectLoaded, const LoadOptions &options = LoadOptions(),
+        LoadStatistics *stats = 0);
+    static bool GetObjectIndex(const std::string &filePath, OBJECT_INDEX *putIndexHere,
+        bool useIndexCache = true);
+    static bool LoadObjSelected(const std::string &filePath,
+        const std::vector<std::string> &objectNames, GEOMETRY_DATA_BY_NAME *putDataHere,
+        const LoadOptions &options = LoadOptions(), LoadStatistics *stats = 0);
+
+    static std::string UniqueObjectName(const std::string &objectName,
+        const GEOMETRY_DATA_BY_NAME &existingObjects);
 };
\ No newline at end of file
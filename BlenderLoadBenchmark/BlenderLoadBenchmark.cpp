@@ -0,0 +1,723 @@
+// Benchmarks for the .obj loader.  Not part of the demo itself.
+// Usage: BlenderLoadBenchmark <benchmark> [arguments]
+// Run with no arguments to list the benchmarks.
+
+// for printf(...) and sscanf(...)
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../FastNumberParse.h"
+#include "../BlenderLoad.h"
+#include "../ProcessMemory.h"
+#include "../SceneManifest.h"
+#include "../TranslatedCopies.h"
+#include "../VertexLayout.h"
+
+// every operator new in the program goes through the replacements below so that the "load"
+// benchmark can count the loader's allocations
+static std::atomic<unsigned long long> gNumAllocations(0);
+static std::atomic<unsigned long long> gNumAllocatedBytes(0);
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Replaces the global operator new so that allocations can be counted.  The array and (sized)
+    delete versions are replaced to match because memory from malloc(...) must go back through
+    free(...).
+Parameters:
+    numBytes    Self-explanatory.
+Returns:
+    The memory.
+Exception:  Throws std::bad_alloc if out of memory (required of operator new).
+-----------------------------------------------------------------------------------------------*/
+void *operator new(size_t numBytes)
+{
+    gNumAllocations++;
+    gNumAllocatedBytes += numBytes;
+
+    // malloc(0) may return null, which operator new must not
+    void *memory = malloc((numBytes > 0) ? numBytes : 1);
+    if (memory == 0)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void *operator new[](size_t numBytes)
+{
+    return operator new(numBytes);
+}
+
+void operator delete(void *memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+    free(memory);
+}
+
+void operator delete[](void *memory, size_t) noexcept
+{
+    free(memory);
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    A stopwatch for the benchmarks.
+Parameters: None
+Returns:
+    The number of seconds since some arbitrary point in the past.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static double SecondsNow()
+{
+    std::chrono::duration<double> sinceEpoch =
+        std::chrono::steady_clock::now().time_since_epoch();
+    return sinceEpoch.count();
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Tells an optional count argument (such as a thread count) apart from the option names that
+    may follow it.
+Parameters:
+    arg     Self-explanatory.
+Returns:
+    True if the string is non-empty and is nothing but the digits 0-9, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static bool IsAllDigits(const char *arg)
+{
+    if (*arg == 0)
+    {
+        return false;
+    }
+    for (; *arg != 0; arg++)
+    {
+        if (*arg < '0' || *arg > '9')
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Times ParseFloat(...) and ParseUnsignedInt(...) against sscanf(...) on the kind of numbers
+    that Blender writes: "%.6f" floats on [-1, +1] and 1-based vertex indices.
+
+    Note: To keep the comparison fair, every number is stored null-terminated so that
+    sscanf(...) doesn't have to scan past it.  The results of both are compared so that the
+    benchmark doubles as a sanity check.
+Parameters:
+    argc    The number of arguments after the benchmark name.
+    argv    [0] (optional) How many numbers to parse.  Default is 10 million.
+Returns:
+    0 if every value matched, otherwise 1.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static int BenchmarkNumberParsing(int argc, char *argv[])
+{
+    size_t numValues = (argc > 0) ? strtoul(argv[0], 0, 10) : 10000000;
+
+    // fixed seed so that runs are comparable
+    std::mt19937 generator(1234);
+    std::uniform_real_distribution<float> floatDistribution(-1.0f, 1.0f);
+    std::uniform_int_distribution<unsigned int> indexDistribution(1, 5000000);
+
+    std::string floatText;
+    std::string indexText;
+    std::vector<size_t> floatOffsets(numValues);
+    std::vector<size_t> indexOffsets(numValues);
+    char buffer[64];
+    for (size_t valueIndex = 0; valueIndex < numValues; valueIndex++)
+    {
+        floatOffsets[valueIndex] = floatText.size();
+        int numChars = snprintf(buffer, sizeof(buffer), "%.6f", floatDistribution(generator));
+        floatText.append(buffer, numChars + 1);
+
+        indexOffsets[valueIndex] = indexText.size();
+        numChars = snprintf(buffer, sizeof(buffer), "%u", indexDistribution(generator));
+        indexText.append(buffer, numChars + 1);
+    }
+
+    std::vector<float> sscanfFloats(numValues);
+    std::vector<float> fastFloats(numValues);
+    std::vector<unsigned int> sscanfIndices(numValues);
+    std::vector<unsigned int> fastIndices(numValues);
+
+    double startSeconds = SecondsNow();
+    for (size_t valueIndex = 0; valueIndex < numValues; valueIndex++)
+    {
+        sscanf(floatText.c_str() + floatOffsets[valueIndex], "%f", &sscanfFloats[valueIndex]);
+    }
+    double sscanfFloatSeconds = SecondsNow() - startSeconds;
+
+    startSeconds = SecondsNow();
+    for (size_t valueIndex = 0; valueIndex < numValues; valueIndex++)
+    {
+        const char *begin = floatText.c_str() + floatOffsets[valueIndex];
+        ParseFloat(begin, floatText.c_str() + floatText.size(), &fastFloats[valueIndex]);
+    }
+    double fastFloatSeconds = SecondsNow() - startSeconds;
+
+    startSeconds = SecondsNow();
+    for (size_t valueIndex = 0; valueIndex < numValues; valueIndex++)
+    {
+        sscanf(indexText.c_str() + indexOffsets[valueIndex], "%u", &sscanfIndices[valueIndex]);
+    }
+    double sscanfIndexSeconds = SecondsNow() - startSeconds;
+
+    startSeconds = SecondsNow();
+    for (size_t valueIndex = 0; valueIndex < numValues; valueIndex++)
+    {
+        const char *begin = indexText.c_str() + indexOffsets[valueIndex];
+        ParseUnsignedInt(begin, indexText.c_str() + indexText.size(), &fastIndices[valueIndex]);
+    }
+    double fastIndexSeconds = SecondsNow() - startSeconds;
+
+    size_t numMismatches = 0;
+    for (size_t valueIndex = 0; valueIndex < numValues; valueIndex++)
+    {
+        // compare bits, not values, so that -0.0 vs 0.0 would be caught too
+        if (memcmp(&sscanfFloats[valueIndex], &fastFloats[valueIndex], sizeof(float)) != 0 ||
+            sscanfIndices[valueIndex] != fastIndices[valueIndex])
+        {
+            numMismatches++;
+        }
+    }
+
+    double megabytes = 1.0 / (1024.0 * 1024.0);
+    printf("parsed %u values of each kind\n", static_cast<unsigned int>(numValues));
+    printf("floats:  sscanf %7.1f ns/value (%7.1f MB/s), "
+        "ParseFloat       %7.1f ns/value (%7.1f MB/s), %5.1fx\n",
+        sscanfFloatSeconds * 1e9 / numValues, floatText.size() * megabytes / sscanfFloatSeconds,
+        fastFloatSeconds * 1e9 / numValues, floatText.size() * megabytes / fastFloatSeconds,
+        sscanfFloatSeconds / fastFloatSeconds);
+    printf("indices: sscanf %7.1f ns/value (%7.1f MB/s), "
+        "ParseUnsignedInt %7.1f ns/value (%7.1f MB/s), %5.1fx\n",
+        sscanfIndexSeconds * 1e9 / numValues, indexText.size() * megabytes / sscanfIndexSeconds,
+        fastIndexSeconds * 1e9 / numValues, indexText.size() * megabytes / fastIndexSeconds,
+        sscanfIndexSeconds / fastIndexSeconds);
+    printf("mismatches: %u\n", static_cast<unsigned int>(numMismatches));
+
+    return (numMismatches == 0) ? 0 : 1;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Writes a Blender-style .obj file with a lot more than 65535 positions, loads it, and checks
+    that every vertex came from the right position.  Each position's X is its own 0-based index,
+    so a vertex that was built from the wrong index is easy to spot.
+
+    The file has a "Lines" object that joins every pair of positions and a "Quads" object that
+    makes a face out of every 4 positions, so both kinds of records use indices right up to the
+    last position.
+Parameters:
+    argc    The number of arguments after the benchmark name.
+    argv    [0] (optional) How many positions to write.  Default is 4 million.
+            [1] (optional) Threads for LoadObj(...).  Default is 1.
+Returns:
+    0 if every vertex was right, otherwise 1.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static int BenchmarkIndexStress(int argc, char *argv[])
+{
+    unsigned int numPositions = (argc > 0) ? strtoul(argv[0], 0, 10) : 4000000;
+    unsigned int numThreads = (argc > 1) ? strtoul(argv[1], 0, 10) : 1;
+
+    // whole faces only
+    numPositions -= numPositions % 4;
+    if (numPositions == 0)
+    {
+        printf("need at least 4 positions\n");
+        return 1;
+    }
+
+    std::string filePath = "index_stress.obj";
+    std::ofstream objFile(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!objFile.is_open())
+    {
+        printf("could not write '%s'\n", filePath.c_str());
+        return 1;
+    }
+
+    char buffer[128];
+    objFile << "# Blender v2.78 (sub 0) OBJ File: ''\n# www.blender.org\nmtllib none.mtl\n";
+    objFile << "o Lines\n";
+    for (unsigned int positionIndex = 0; positionIndex < numPositions; positionIndex++)
+    {
+        snprintf(buffer, sizeof(buffer), "v %u.000000 0.000000 0.000000\n", positionIndex);
+        objFile << buffer;
+    }
+    objFile << "vn 0.0000 0.0000 1.0000\n";
+    for (unsigned int positionIndex = 1; positionIndex < numPositions; positionIndex += 2)
+    {
+        snprintf(buffer, sizeof(buffer), "l %u %u\n", positionIndex, positionIndex + 1);
+        objFile << buffer;
+    }
+    objFile << "o Quads\n";
+    for (unsigned int positionIndex = 1; positionIndex < numPositions; positionIndex += 4)
+    {
+        snprintf(buffer, sizeof(buffer), "f %u//1 %u//1 %u//1 %u//1\n", positionIndex,
+            positionIndex + 1, positionIndex + 2, positionIndex + 3);
+        objFile << buffer;
+    }
+    objFile.close();
+
+    BlenderLoad::LoadOptions options;
+    options._numThreads = numThreads;
+    options._useBinaryCache = false;
+    BlenderLoad::LoadStatistics stats;
+    BlenderLoad::GEOMETRY_DATA_BY_NAME geometry;
+    bool loaded = BlenderLoad::LoadObj(filePath, &geometry, options, &stats);
+    remove(filePath.c_str());
+    if (!loaded)
+    {
+        printf("LoadObj(...) failed\n");
+        return 1;
+    }
+
+    // Add(...) rather than Find(...) so that a missing object comes out empty and is counted as
+    // a mismatch; both are added before either is looked at because adding may move the others
+    GeometryRegistry::HANDLE linesObject = geometry.Add("Lines");
+    GeometryRegistry::HANDLE quadsObject = geometry.Add("Quads");
+
+    size_t numMismatches = 0;
+    const std::vector<MyVertex> &lineVerts = geometry.Geometry(linesObject)._verts;
+    if (lineVerts.size() != numPositions)
+    {
+        numMismatches++;
+    }
+    for (size_t vertIndex = 0; vertIndex < lineVerts.size(); vertIndex++)
+    {
+        if (lineVerts[vertIndex]._position.x != static_cast<float>(vertIndex))
+        {
+            numMismatches++;
+        }
+    }
+
+    // each quad's corners (0,1,2,3) become triangles (0,1,2) and (2,3,0)
+    static const unsigned int QUAD_CORNERS[6] = { 0, 1, 2, 2, 3, 0 };
+    const std::vector<MyVertex> &quadVerts = geometry.Geometry(quadsObject)._verts;
+    if (quadVerts.size() != (numPositions / 4) * 6)
+    {
+        numMismatches++;
+    }
+    for (size_t vertIndex = 0; vertIndex < quadVerts.size(); vertIndex++)
+    {
+        size_t firstCorner = (vertIndex / 6) * 4;
+        float expectedX = static_cast<float>(firstCorner + QUAD_CORNERS[vertIndex % 6]);
+        if (quadVerts[vertIndex]._position.x != expectedX)
+        {
+            numMismatches++;
+        }
+    }
+
+    printf("loaded %u positions with %u thread(s) in %.3f seconds (%.2f MB/s)\n",
+        numPositions, numThreads, stats._parseSeconds, stats.MegabytesPerSecond());
+    printf("mismatches: %u\n", static_cast<unsigned int>(numMismatches));
+
+    return (numMismatches == 0) ? 0 : 1;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Runs BlenderLoad::LoadObj(...) (or LoadObjStreaming(...)) on a file and reports how long it
+    took, the throughput, how many allocations it made, and the process' peak memory.  Use
+    ObjSceneGenerator to make files of any size.
+
+    Note: The binary cache is off unless "cache" is given, since the point is usually to
+    measure the parser.  A ".gz" or ".zst" file is decompressed as it is parsed.  Each option
+    is a separate argument:
+    - getline       std::ifstream + std::getline(...) instead of memory-mapping
+    - cache         use (and write) the binary cache
+    - noprealloc    skip the counting pass (LoadOptions::_preallocate = false)
+    - weld          weld the vertices
+    - stitch        also stitch line objects into strips (see LineStitch.h)
+    - quantize      measure the quantization error (see Vertex2DQuantized)
+    - instance      afterwards, turn translated copies into instances (see TranslatedCopies.h)
+                    and report how much that saved; timed separately, but its allocations
+                    are counted with the load's; not with "streaming"
+    - streaming     LoadObjStreaming(...); each object is thrown away as soon as it arrives
+    - memory        read the whole file first (not timed), then LoadObjFromMemory(...), so
+                    that only the parsing is measured
+    - only=<name>   LoadObjSelected(...) with just this object; may be given more than once
+Parameters:
+    argc    The number of arguments after the benchmark name.
+    argv    [0] The .obj file.
+            [1] (optional) Threads for LoadObj(...).  0 means one per hardware thread.
+                Default is 1.  If this isn't a number, it is the first option instead.
+            [2...] (optional) Options (see above).
+Returns:
+    0 if the load worked, otherwise 1.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static int BenchmarkLoad(int argc, char *argv[])
+{
+    if (argc < 1)
+    {
+        printf("need a .obj file\n");
+        return 1;
+    }
+    std::string filePath = argv[0];
+
+    BlenderLoad::LoadOptions options;
+    options._numThreads = 1;
+    int firstOptionIndex = 1;
+    if (argc > 1 && IsAllDigits(argv[1]))
+    {
+        options._numThreads = strtoul(argv[1], 0, 10);
+        firstOptionIndex = 2;
+    }
+    options._useBinaryCache = false;
+    bool streaming = false;
+    bool fromMemory = false;
+    bool instanceCopies = false;
+    std::vector<std::string> selectedNames;
+    for (int argIndex = firstOptionIndex; argIndex < argc; argIndex++)
+    {
+        if (strcmp(argv[argIndex], "getline") == 0)
+        {
+            options._useMemoryMap = false;
+        }
+        else if (strcmp(argv[argIndex], "cache") == 0)
+        {
+            options._useBinaryCache = true;
+        }
+        else if (strcmp(argv[argIndex], "noprealloc") == 0)
+        {
+            options._preallocate = false;
+        }
+        else if (strcmp(argv[argIndex], "weld") == 0)
+        {
+            options._weldVertices = true;
+        }
+        else if (strcmp(argv[argIndex], "stitch") == 0)
+        {
+            options._weldVertices = true;
+            options._stitchLines = true;
+        }
+        else if (strcmp(argv[argIndex], "quantize") == 0)
+        {
+            options._quantizeVertices = true;
+        }
+        else if (strcmp(argv[argIndex], "instance") == 0)
+        {
+            instanceCopies = true;
+        }
+        else if (strcmp(argv[argIndex], "streaming") == 0)
+        {
+            streaming = true;
+        }
+        else if (strcmp(argv[argIndex], "memory") == 0)
+        {
+            fromMemory = true;
+        }
+        else if (strncmp(argv[argIndex], "only=", 5) == 0)
+        {
+            selectedNames.push_back(argv[argIndex] + 5);
+        }
+        else
+        {
+            printf("unknown option '%s'\n", argv[argIndex]);
+            return 1;
+        }
+    }
+    if (streaming && instanceCopies)
+    {
+        printf("'instance' needs the whole scene, so it doesn't work with 'streaming'\n");
+        return 1;
+    }
+
+    std::vector<char> fileText;
+    if (fromMemory)
+    {
+        std::ifstream objFile(filePath, std::ios::in | std::ios::binary);
+        if (!objFile.is_open())
+        {
+            printf("could not read '%s'\n", filePath.c_str());
+            return 1;
+        }
+        fileText.assign(std::istreambuf_iterator<char>(objFile),
+            std::istreambuf_iterator<char>());
+    }
+
+    unsigned long long peakBytesBefore = PeakResidentBytes();
+    unsigned long long numAllocationsBefore = gNumAllocations;
+    unsigned long long numAllocatedBytesBefore = gNumAllocatedBytes;
+
+    BlenderLoad::LoadStatistics stats;
+    size_t numObjects = 0;
+    size_t numVerts = 0;
+    size_t numIndices = 0;
+    size_t numCopies = 0;
+    size_t numVertsDropped = 0;
+    double instanceSeconds = 0.0;
+    bool loaded = false;
+    if (streaming)
+    {
+        BlenderLoad::OBJECT_CALLBACK countObject = [&numObjects, &numVerts, &numIndices](
+            const std::string &, GeometryData *geometryData)
+        {
+            numObjects++;
+            numVerts += geometryData->_verts.size();
+            numIndices += geometryData->_indices.size();
+        };
+        loaded = BlenderLoad::LoadObjStreaming(filePath, countObject, options, &stats);
+    }
+    else
+    {
+        BlenderLoad::GEOMETRY_DATA_BY_NAME geometry;
+        if (!selectedNames.empty())
+        {
+            loaded = BlenderLoad::LoadObjSelected(filePath, selectedNames, &geometry, options,
+                &stats);
+        }
+        else if (fromMemory)
+        {
+            loaded = BlenderLoad::LoadObjFromMemory(fileText.data(), fileText.size(), &geometry,
+                options, &stats);
+        }
+        else
+        {
+            loaded = BlenderLoad::LoadObj(filePath, &geometry, options, &stats);
+        }
+        if (loaded && instanceCopies)
+        {
+            std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+            TranslatedCopyFinder copyFinder;
+            for (GeometryRegistry::HANDLE handle = 0; handle < geometry.Size(); handle++)
+            {
+                copyFinder.Process(&geometry, handle);
+            }
+            std::chrono::duration<double> elapsed =
+                std::chrono::steady_clock::now() - startTime;
+            instanceSeconds = elapsed.count();
+            numCopies = copyFinder.NumCopies();
+            numVertsDropped = copyFinder.NumVertsDropped();
+        }
+        numObjects = geometry.Size();
+        for (GeometryRegistry::HANDLE handle = 0; handle < geometry.Size(); handle++)
+        {
+            numVerts += geometry.Geometry(handle)._verts.size();
+            numIndices += geometry.Geometry(handle)._indices.size();
+        }
+    }
+
+    unsigned long long numAllocations = gNumAllocations - numAllocationsBefore;
+    unsigned long long numAllocatedBytes = gNumAllocatedBytes - numAllocatedBytesBefore;
+    if (!loaded)
+    {
+        printf("load failed\n");
+        return 1;
+    }
+
+    double megabytes = 1.0 / (1024.0 * 1024.0);
+    printf("file:        %s (%.2f MB)%s\n", filePath.c_str(), stats._bytesParsed * megabytes,
+        stats._loadedFromCache ? " from the cache" : "");
+    if (stats._compressedBytes > 0)
+    {
+        printf("compressed:  %.2f MB (%.1fx)\n", stats._compressedBytes * megabytes,
+            static_cast<double>(stats._bytesParsed) / stats._compressedBytes);
+    }
+    printf("output:      %u objects, %u vertices, %u indices\n",
+        static_cast<unsigned int>(numObjects), static_cast<unsigned int>(numVerts),
+        static_cast<unsigned int>(numIndices));
+    printf("time:        %.3f seconds (%.3f counting, %.3f welding, %.3f cache), %.2f MB/s\n",
+        stats._parseSeconds, stats._prescanSeconds, stats._weldSeconds, stats._cacheSeconds,
+        stats.MegabytesPerSecond());
+    if (!stats._loadedFromCache)
+    {
+        const BlenderLoad::LineCounts &lines = stats._lineCounts;
+        printf("lines:       %llu (o %llu, v %llu, vn %llu, f %llu, l %llu, other %llu, "
+            "unknown %llu)\n", lines.Total(), lines._objectNames, lines._positions,
+            lines._normals, lines._faces, lines._lines,
+            lines._useMaterials + lines._smoothShading + lines._comments, lines._unknown);
+        printf("emitted:     %llu vertices before welding\n", stats._numVertsEmitted);
+    }
+    if (!stats._quantizationStats.empty())
+    {
+        float maxPositionError = 0.0f;
+        float maxNormalError = 0.0f;
+        for (size_t objectIndex = 0; objectIndex < stats._quantizationStats.size();
+            objectIndex++)
+        {
+            const BlenderLoad::QuantizationStatistics &objectStats =
+                stats._quantizationStats[objectIndex];
+            maxPositionError = std::max(maxPositionError, objectStats._maxPositionError);
+            maxNormalError = std::max(maxNormalError, objectStats._maxNormalError);
+        }
+        printf("quantized:   %.2f MB of vertices, worst error %g (position), %g (normal)\n",
+            numVerts * sizeof(Vertex2DQuantized) * megabytes, maxPositionError, maxNormalError);
+    }
+    if (instanceCopies)
+    {
+        printf("instanced:   %u copies of %u meshes, %.2f MB of vertices dropped, "
+            "%.3f seconds\n", static_cast<unsigned int>(numCopies),
+            static_cast<unsigned int>(numObjects - numCopies),
+            numVertsDropped * sizeof(MyVertex) * megabytes, instanceSeconds);
+    }
+    printf("allocations: %llu (%.2f MB)\n", numAllocations, numAllocatedBytes * megabytes);
+    printf("peak memory: %.2f MB (%.2f MB before loading)\n",
+        stats._peakResidentBytes * megabytes, peakBytesBefore * megabytes);
+
+    return 0;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Loads every file in a scene manifest (see SceneManifest) and lists the files from slowest
+    to fastest so that the assets that hold up loading can be found.
+
+    Note: As with "load", the binary cache is off unless "cache" is given.
+Parameters:
+    argc    The number of arguments after the benchmark name.
+    argv    [0] The ".scene" file.
+            [1] (optional) How many files to load at once.  0 means one per hardware thread.
+                Default is 0.  If this isn't a number, it is the first option instead.
+            [2...] (optional) "weld" and/or "cache".
+Returns:
+    0 if every file loaded, otherwise 1.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static int BenchmarkScene(int argc, char *argv[])
+{
+    if (argc < 1)
+    {
+        printf("need a .scene file\n");
+        return 1;
+    }
+
+    BlenderLoad::LoadOptions options;
+    options._useBinaryCache = false;
+    unsigned int numFileThreads = 0;
+    int firstOptionIndex = 1;
+    if (argc > 1 && IsAllDigits(argv[1]))
+    {
+        numFileThreads = strtoul(argv[1], 0, 10);
+        firstOptionIndex = 2;
+    }
+    for (int argIndex = firstOptionIndex; argIndex < argc; argIndex++)
+    {
+        if (strcmp(argv[argIndex], "weld") == 0)
+        {
+            options._weldVertices = true;
+        }
+        else if (strcmp(argv[argIndex], "cache") == 0)
+        {
+            options._useBinaryCache = true;
+        }
+        else
+        {
+            printf("unknown option '%s'\n", argv[argIndex]);
+            return 1;
+        }
+    }
+
+    std::vector<SceneManifest::Entry> entries;
+    if (!SceneManifest::Read(argv[0], &entries))
+    {
+        return 1;
+    }
+
+    BlenderLoad::GEOMETRY_DATA_BY_NAME geometry;
+    std::vector<SceneManifest::FileStatistics> fileStats;
+    BlenderLoad::LoadStatistics totalStats;
+    bool loaded = SceneManifest::Load(entries, options, numFileThreads, &geometry, &fileStats,
+        &totalStats);
+
+    std::sort(fileStats.begin(), fileStats.end(),
+        [](const SceneManifest::FileStatistics &left, const SceneManifest::FileStatistics &right)
+    {
+        return left._stats._parseSeconds > right._stats._parseSeconds;
+    });
+
+    double megabytes = 1.0 / (1024.0 * 1024.0);
+    printf("%-10s %-10s %-10s %-8s %s\n", "seconds", "MB", "MB/s", "objects", "file");
+    for (size_t fileIndex = 0; fileIndex < fileStats.size(); fileIndex++)
+    {
+        const SceneManifest::FileStatistics &stats = fileStats[fileIndex];
+        printf("%-10.3f %-10.2f %-10.2f %-8u %s%s\n", stats._stats._parseSeconds,
+            stats._stats._bytesParsed * megabytes, stats._stats.MegabytesPerSecond(),
+            static_cast<unsigned int>(stats._numObjects), stats._filePath.c_str(),
+            stats._succeeded ? "" : " (FAILED)");
+    }
+
+    printf("scene:       %u files, %u objects, %.2f MB in %.3f seconds (%.2f MB/s)\n",
+        static_cast<unsigned int>(entries.size()), static_cast<unsigned int>(geometry.Size()),
+        totalStats._bytesParsed * megabytes, totalStats._parseSeconds,
+        totalStats.MegabytesPerSecond());
+    printf("peak memory: %.2f MB\n", totalStats._peakResidentBytes * megabytes);
+
+    return loaded ? 0 : 1;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Picks a benchmark by name and runs it.
+Parameters:
+    argc    The number of strings in argv.
+    argv    [1] is the benchmark name, and the rest are passed to the benchmark.
+Returns:
+    0 if the benchmark ran fine, otherwise non-zero.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+int main(int argc, char *argv[])
+{
+    struct Benchmark
+    {
+        const char *_name;
+        const char *_usage;
+        int (*_run)(int argc, char *argv[]);
+    };
+
+    static const Benchmark benchmarks[] =
+    {
+        { "numbers", "numbers [count]", BenchmarkNumberParsing },
+        { "index-stress", "index-stress [positions] [threads]", BenchmarkIndexStress },
+        { "load",
+            "load <file.obj> [threads] [getline] [cache] [noprealloc] [weld] [stitch] "
+            "[quantize] [instance] [streaming] [memory] [only=<name>...]",
+            BenchmarkLoad },
+        { "scene", "scene <file.scene> [file threads] [weld] [cache]", BenchmarkScene },
+    };
+    static const size_t numBenchmarks = sizeof(benchmarks) / sizeof(benchmarks[0]);
+
+    if (argc >= 2)
+    {
+        for (size_t benchmarkIndex = 0; benchmarkIndex < numBenchmarks; benchmarkIndex++)
+        {
+            if (strcmp(argv[1], benchmarks[benchmarkIndex]._name) == 0)
+            {
+                return benchmarks[benchmarkIndex]._run(argc - 2, argv + 2);
+            }
+        }
+    }
+
+    printf("usage:\n");
+    for (size_t benchmarkIndex = 0; benchmarkIndex < numBenchmarks; benchmarkIndex++)
+    {
+        printf("    %s %s\n", argv[0], benchmarks[benchmarkIndex]._usage);
+    }
+    return 1;
+}
@@ -0,0 +1,471 @@
+#include "DecompressionStream.h"
+
+#include <algorithm>
+
+#ifdef BLENDER_LOAD_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef BLENDER_LOAD_ZSTD
+#include <zstd.h>
+#endif
+
+// each block is parsed while the next is decompressed, and text .obj files compress well, so
+// a block is big enough that the threads rarely have to wait on each other
+static const size_t BLOCK_SIZE_BYTES = 1024 * 1024;
+
+// the most decompressed blocks that are held at once, counting the one that the caller is
+// parsing
+static const size_t MAX_BLOCKS = 4;
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Figures out if a file is compressed by looking at its extension.
+Parameters:
+    filePath    Self-explanatory.
+Returns:
+    COMPRESSION_GZIP for ".gz", COMPRESSION_ZSTD for ".zst", otherwise COMPRESSION_NONE.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+CompressionFormat CompressionFormatForPath(const std::string &filePath)
+{
+    struct Extension
+    {
+        const char *_extension;
+        CompressionFormat _format;
+    };
+
+    static const Extension extensions[] =
+    {
+        { ".gz", COMPRESSION_GZIP },
+        { ".zst", COMPRESSION_ZSTD },
+    };
+
+    for (size_t extensionIndex = 0; extensionIndex < sizeof(extensions) / sizeof(extensions[0]);
+        extensionIndex++)
+    {
+        std::string extension = extensions[extensionIndex]._extension;
+        if (filePath.length() > extension.length() &&
+            filePath.compare(filePath.length() - extension.length(), extension.length(),
+            extension) == 0)
+        {
+            return extensions[extensionIndex]._format;
+        }
+    }
+
+    return COMPRESSION_NONE;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    For messages.
+Parameters:
+    format  Self-explanatory.
+Returns:
+    A short name for the format.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+const char *CompressionFormatName(CompressionFormat format)
+{
+    switch (format)
+    {
+    case COMPRESSION_GZIP:
+        return "gzip";
+    case COMPRESSION_ZSTD:
+        return "zstd";
+    default:
+        return "uncompressed";
+    }
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Ensures that the object starts with initialized values.  Nothing happens until Start(...)
+    is called.
+Parameters: None
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+DecompressionStream::DecompressionStream() :
+    _compressedData(0),
+    _numCompressedBytes(0),
+    _format(COMPRESSION_NONE),
+    _numBlocksInUse(0),
+    _finished(false),
+    _failed(false),
+    _cancelRequested(false)
+{
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Stops the decompression thread (if any) and waits for it.  It is fine to stop reading
+    blocks part way through.
+Parameters: None
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+DecompressionStream::~DecompressionStream()
+{
+    {
+        std::lock_guard<std::mutex> lock(_blocksMutex);
+        _cancelRequested = true;
+    }
+    _blocksChanged.notify_all();
+
+    if (_decompressThread.joinable())
+    {
+        _decompressThread.join();
+    }
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Tells whether this build can decompress a format (see the class description).
+Parameters:
+    format  Self-explanatory.
+Returns:
+    True if Start(...) can be given the format, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool DecompressionStream::FormatIsSupported(CompressionFormat format)
+{
+    switch (format)
+    {
+#ifdef BLENDER_LOAD_ZLIB
+    case COMPRESSION_GZIP:
+        return true;
+#endif
+#ifdef BLENDER_LOAD_ZSTD
+    case COMPRESSION_ZSTD:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Starts decompressing on a background thread.
+Parameters:
+    compressedData      Must stay valid until this object is destroyed.
+    numCompressedBytes  Self-explanatory.
+    format              See FormatIsSupported(...).
+Returns:
+    True if the thread was started, otherwise false (unsupported format, or already started).
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool DecompressionStream::Start(const char *compressedData, size_t numCompressedBytes,
+    CompressionFormat format)
+{
+    if (_decompressThread.joinable() || !FormatIsSupported(format))
+    {
+        return false;
+    }
+
+    _compressedData = compressedData;
+    _numCompressedBytes = numCompressedBytes;
+    _format = format;
+    _decompressThread = std::thread(&DecompressionStream::DecompressOnThisThread, this);
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Waits for the next block of decompressed data.  Blocks come out in order and always hold
+    at least 1 byte, but they are cut at arbitrary places (in the middle of a line, say).
+Parameters:
+    block   Gets the next block.  Whatever it held before is given back to the decompression
+            thread to be reused, so pass the same vector every time.
+Returns:
+    True if there was another block, otherwise false (the end of the data, or an error; see
+    Failed()).
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool DecompressionStream::NextBlock(std::vector<char> *block)
+{
+    std::unique_lock<std::mutex> lock(_blocksMutex);
+    if (block->capacity() > 0)
+    {
+        block->clear();
+        _emptyBlocks.push_back(std::vector<char>());
+        _emptyBlocks.back().swap(*block);
+        _blocksChanged.notify_all();
+    }
+
+    _blocksChanged.wait(lock, [this]() { return !_fullBlocks.empty() || _finished; });
+    if (_fullBlocks.empty())
+    {
+        return false;
+    }
+
+    block->swap(_fullBlocks.front());
+    _fullBlocks.pop_front();
+    _blocksChanged.notify_all();
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Tells whether the data turned out to be corrupt or truncated.  Only meaningful once
+    NextBlock(...) has returned false.
+Parameters: None
+Returns:
+    True if decompression failed, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool DecompressionStream::Failed()
+{
+    std::lock_guard<std::mutex> lock(_blocksMutex);
+    return _failed;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    The decompression thread's body.
+Parameters: None
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+void DecompressionStream::DecompressOnThisThread()
+{
+    bool success = false;
+    if (_format == COMPRESSION_GZIP)
+    {
+        success = Inflate();
+    }
+    else if (_format == COMPRESSION_ZSTD)
+    {
+        success = DecompressZstd();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_blocksMutex);
+        _failed = !success && !_cancelRequested;
+        _finished = true;
+    }
+    _blocksChanged.notify_all();
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Decompresses gzip (or zlib) data with zlib.  A file that is several gzip members end to end
+    (as "cat a.gz b.gz" makes) comes out as one.
+Parameters: None
+Returns:
+    True if all of the data was decompressed, otherwise false (corrupt, truncated, canceled,
+    or not built with zlib).
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool DecompressionStream::Inflate()
+{
+#ifdef BLENDER_LOAD_ZLIB
+    z_stream stream = {};
+
+    // 15 is the largest window, and +32 detects the gzip or zlib header on its own
+    if (inflateInit2(&stream, 15 + 32) != Z_OK)
+    {
+        return false;
+    }
+
+    // avail_in is only 32 bits, so big files are fed in a piece at a time
+    static const size_t MAX_INPUT_BYTES = 1024 * 1024 * 1024;
+    const char *nextInput = _compressedData;
+    size_t numInputBytesLeft = _numCompressedBytes;
+
+    bool success = false;
+    std::vector<char> block;
+    while (TakeEmptyBlock(&block))
+    {
+        block.resize(BLOCK_SIZE_BYTES);
+        stream.next_out = reinterpret_cast<Bytef *>(block.data());
+        stream.avail_out = static_cast<uInt>(block.size());
+
+        int result = Z_OK;
+        while (stream.avail_out > 0)
+        {
+            if (stream.avail_in == 0 && numInputBytesLeft > 0)
+            {
+                size_t numInputBytes = std::min(numInputBytesLeft, MAX_INPUT_BYTES);
+                stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(nextInput));
+                stream.avail_in = static_cast<uInt>(numInputBytes);
+                nextInput += numInputBytes;
+                numInputBytesLeft -= numInputBytes;
+            }
+
+            result = inflate(&stream, Z_NO_FLUSH);
+            if (result == Z_STREAM_END)
+            {
+                if (stream.avail_in == 0 && numInputBytesLeft == 0)
+                {
+                    break;
+                }
+
+                // another gzip member follows
+                inflateReset(&stream);
+                result = Z_OK;
+            }
+            else if (result != Z_OK)
+            {
+                // Z_BUF_ERROR here means that the data ran out part way through
+                break;
+            }
+        }
+
+        block.resize(block.size() - stream.avail_out);
+        QueueFullBlock(&block);
+
+        if (result == Z_STREAM_END)
+        {
+            success = true;
+            break;
+        }
+        if (result != Z_OK)
+        {
+            break;
+        }
+    }
+
+    inflateEnd(&stream);
+    return success;
+#else
+    return false;
+#endif
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Decompresses zstd data with libzstd.  Several frames end to end come out as one.
+Parameters: None
+Returns:
+    True if all of the data was decompressed, otherwise false (corrupt, truncated, canceled,
+    or not built with libzstd).
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool DecompressionStream::DecompressZstd()
+{
+#ifdef BLENDER_LOAD_ZSTD
+    ZSTD_DStream *stream = ZSTD_createDStream();
+    if (stream == 0)
+    {
+        return false;
+    }
+    ZSTD_initDStream(stream);
+
+    ZSTD_inBuffer input = { _compressedData, _numCompressedBytes, 0 };
+
+    // 0 means that the last frame was finished
+    size_t hint = 1;
+
+    bool success = false;
+    std::vector<char> block;
+    while (TakeEmptyBlock(&block))
+    {
+        block.resize(BLOCK_SIZE_BYTES);
+        ZSTD_outBuffer output = { block.data(), block.size(), 0 };
+
+        bool failed = false;
+        while (output.pos < output.size && input.pos < input.size)
+        {
+            hint = ZSTD_decompressStream(stream, &output, &input);
+            if (ZSTD_isError(hint))
+            {
+                failed = true;
+                break;
+            }
+        }
+
+        // the decoder may still be holding output after all of the input has gone in
+        while (!failed && output.pos < output.size && input.pos == input.size && hint != 0)
+        {
+            size_t outputBefore = output.pos;
+            hint = ZSTD_decompressStream(stream, &output, &input);
+            if (ZSTD_isError(hint) || output.pos == outputBefore)
+            {
+                // no progress without more input, so the data was cut off
+                failed = true;
+                break;
+            }
+        }
+
+        block.resize(output.pos);
+        QueueFullBlock(&block);
+
+        if (failed)
+        {
+            break;
+        }
+        if (input.pos == input.size && hint == 0 && output.pos < output.size)
+        {
+            success = true;
+            break;
+        }
+    }
+
+    ZSTD_freeDStream(stream);
+    return success;
+#else
+    return false;
+#endif
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Decompression thread only.  Waits until a block can be filled without going over
+    MAX_BLOCKS.
+Parameters:
+    block   Gets an empty block (possibly with capacity left over from last time).
+Returns:
+    True if there is a block to fill, otherwise false (canceled).
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool DecompressionStream::TakeEmptyBlock(std::vector<char> *block)
+{
+    std::unique_lock<std::mutex> lock(_blocksMutex);
+    _blocksChanged.wait(lock, [this]()
+    {
+        return _cancelRequested || !_emptyBlocks.empty() || _numBlocksInUse < MAX_BLOCKS;
+    });
+
+    if (_cancelRequested)
+    {
+        return false;
+    }
+
+    if (!_emptyBlocks.empty())
+    {
+        block->swap(_emptyBlocks.back());
+        _emptyBlocks.pop_back();
+    }
+    else
+    {
+        _numBlocksInUse++;
+    }
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Decompression thread only.  Hands a filled block to NextBlock(...).  An empty block is
+    kept for reuse instead.
+Parameters:
+    block   Swapped out (it is left empty).
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+void DecompressionStream::QueueFullBlock(std::vector<char> *block)
+{
+    {
+        std::lock_guard<std::mutex> lock(_blocksMutex);
+        if (block->empty())
+        {
+            _emptyBlocks.push_back(std::vector<char>());
+            _emptyBlocks.back().swap(*block);
+        }
+        else
+        {
+            _fullBlocks.push_back(std::vector<char>());
+            _fullBlocks.back().swap(*block);
+        }
+    }
+    _blocksChanged.notify_all();
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    What a file is compressed with, as told by its extension.
+-----------------------------------------------------------------------------------------------*/
+enum CompressionFormat
+{
+    COMPRESSION_NONE = 0,
+    COMPRESSION_GZIP,   // ".gz"
+    COMPRESSION_ZSTD,   // ".zst"
+};
+
+CompressionFormat CompressionFormatForPath(const std::string &filePath);
+const char *CompressionFormatName(CompressionFormat format);
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Decompresses a block of compressed data on a background thread and hands the output to the
+    caller one block at a time, so that the caller can parse one block while the next one is
+    being decompressed.  At most a few blocks are ever held at once, no matter how big the
+    decompressed data is.
+
+    Note: The decompression libraries are not part of this project.  Define BLENDER_LOAD_ZLIB
+    (and link zlib) for gzip, and BLENDER_LOAD_ZSTD (and link libzstd) for zstd, in the
+    preprocessor settings.  Without them, Start(...) fails for that format.
+
+    Also Note: NextBlock(...) must only be called from one thread.
+-----------------------------------------------------------------------------------------------*/
+class DecompressionStream
+{
+public:
+    DecompressionStream();
+    ~DecompressionStream();
+
+    static bool FormatIsSupported(CompressionFormat format);
+
+    bool Start(const char *compressedData, size_t numCompressedBytes, CompressionFormat format);
+    bool NextBlock(std::vector<char> *block);
+    bool Failed();
+
+private:
+    // the background thread has a pointer to this object, so it must stay put
+    DecompressionStream(const DecompressionStream &) = delete;
+    DecompressionStream &operator=(const DecompressionStream &) = delete;
+
+    void DecompressOnThisThread();
+    bool Inflate();
+    bool DecompressZstd();
+
+    bool TakeEmptyBlock(std::vector<char> *block);
+    void QueueFullBlock(std::vector<char> *block);
+
+    const char *_compressedData;
+    size_t _numCompressedBytes;
+    CompressionFormat _format;
+
+    std::thread _decompressThread;
+
+    // everything below is guarded by the mutex
+    // Note: Blocks go back and forth between the two collections so that the same few
+    // allocations are used for the whole file.
+    std::mutex _blocksMutex;
+    std::condition_variable _blocksChanged;
+    std::deque<std::vector<char>> _fullBlocks;
+    std::vector<std::vector<char>> _emptyBlocks;
+    size_t _numBlocksInUse;
+    bool _finished;
+    bool _failed;
+    bool _cancelRequested;
+};
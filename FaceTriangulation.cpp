@@ -0,0 +1,253 @@
+#include "FaceTriangulation.h"
+
+#include <cmath>
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    The Z component of the cross product of two 2D vectors.
+Parameters:
+    a, b    Self-explanatory.
+Returns:
+    Positive if b turns counterclockwise from a, negative if clockwise, 0 if they are parallel.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static float Cross2D(const glm::vec2 &a, const glm::vec2 &b)
+{
+    return (a.x * b.y) - (a.y * b.x);
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Checks if a point is inside (or on the edge of) a triangle.
+Parameters:
+    point       Self-explanatory.
+    a, b, c     The triangle's corners.
+    orientation +1 if the corners go counterclockwise, -1 if clockwise.
+Returns:
+    True if the point is inside or on the edge, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static bool PointIsInTriangle(const glm::vec2 &point, const glm::vec2 &a, const glm::vec2 &b,
+    const glm::vec2 &c, float orientation)
+{
+    return (Cross2D(b - a, point - a) * orientation >= 0.0f) &&
+        (Cross2D(c - b, point - b) * orientation >= 0.0f) &&
+        (Cross2D(a - c, point - c) * orientation >= 0.0f);
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Cuts a face into triangles.
+
+    Note: A convex face with corners 0..N-1 comes out as (0, 1, 2), then (i, i + 1, 0) for
+    each i from 2 to N - 2.  That is an ordinary fan around corner 0, with every triangle
+    after the first rotated so that a quad comes out as (0, 1, 2), (2, 3, 0).  That's the way
+    the loader has always cut quads, so files made of quads load exactly as before.
+
+    Also Note: Every triangle keeps the winding of the face, so front faces stay front faces.
+Parameters:
+    corners             The face's corner positions, in order around the face.
+    numCorners          At least 3.
+    putTrianglesHere    Cleared, then gets 3 corner numbers (into corners) per triangle.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+void FaceTriangulator::Triangulate(const glm::vec3 *corners, size_t numCorners,
+    std::vector<unsigned int> *putTrianglesHere)
+{
+    putTrianglesHere->clear();
+    if (numCorners < 3)
+    {
+        return;
+    }
+
+    // a triangle is already a triangle, and this is the common case, so skip the projection
+    bool isConvex = true;
+    float orientation = 1.0f;
+    if (numCorners > 3)
+    {
+        ProjectCorners(corners, numCorners);
+
+        // twice the signed area; positive if the corners go counterclockwise
+        float doubleArea = 0.0f;
+        for (size_t cornerIndex = 0; cornerIndex < numCorners; cornerIndex++)
+        {
+            const glm::vec2 &thisCorner = _projectedCorners[cornerIndex];
+            const glm::vec2 &nextCorner = _projectedCorners[(cornerIndex + 1) % numCorners];
+            doubleArea += Cross2D(thisCorner, nextCorner);
+        }
+        orientation = (doubleArea < 0.0f) ? -1.0f : 1.0f;
+        isConvex = ProjectedFaceIsConvex(orientation);
+    }
+
+    if (!isConvex)
+    {
+        ClipEars(orientation, putTrianglesHere);
+        return;
+    }
+
+    putTrianglesHere->push_back(0);
+    putTrianglesHere->push_back(1);
+    putTrianglesHere->push_back(2);
+    for (unsigned int cornerIndex = 2; cornerIndex + 1 < numCorners; cornerIndex++)
+    {
+        putTrianglesHere->push_back(cornerIndex);
+        putTrianglesHere->push_back(cornerIndex + 1);
+        putTrianglesHere->push_back(0);
+    }
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Flattens the corners into 2D by dropping whichever axis the face's normal points along the
+    most.  The normal comes from Newell's method, which works for concave faces and doesn't
+    care which 3 corners it would otherwise have to pick.
+
+    Note: The shapes in this demo are flat in XY, so Z is the one that is dropped.
+Parameters:
+    corners     Self-explanatory.
+    numCorners  Self-explanatory.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+void FaceTriangulator::ProjectCorners(const glm::vec3 *corners, size_t numCorners)
+{
+    glm::vec3 normal(0.0f);
+    for (size_t cornerIndex = 0; cornerIndex < numCorners; cornerIndex++)
+    {
+        const glm::vec3 &thisCorner = corners[cornerIndex];
+        const glm::vec3 &nextCorner = corners[(cornerIndex + 1) % numCorners];
+        normal.x += (thisCorner.y - nextCorner.y) * (thisCorner.z + nextCorner.z);
+        normal.y += (thisCorner.z - nextCorner.z) * (thisCorner.x + nextCorner.x);
+        normal.z += (thisCorner.x - nextCorner.x) * (thisCorner.y + nextCorner.y);
+    }
+
+    // keep the two axes that aren't dropped in cyclic order (YZ, ZX, XY) so that
+    // counterclockwise around the normal stays counterclockwise in 2D
+    int firstAxis = 0;
+    int secondAxis = 1;
+    glm::vec3 absNormal(std::fabs(normal.x), std::fabs(normal.y), std::fabs(normal.z));
+    if (absNormal.x > absNormal.y && absNormal.x > absNormal.z)
+    {
+        firstAxis = 1;
+        secondAxis = 2;
+    }
+    else if (absNormal.y > absNormal.z)
+    {
+        firstAxis = 2;
+        secondAxis = 0;
+    }
+
+    _projectedCorners.resize(numCorners);
+    for (size_t cornerIndex = 0; cornerIndex < numCorners; cornerIndex++)
+    {
+        _projectedCorners[cornerIndex] = glm::vec2(corners[cornerIndex][firstAxis],
+            corners[cornerIndex][secondAxis]);
+    }
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Checks that every corner of the projected face turns the same way.  Straight corners
+    (three corners in a row on a line) are allowed.
+Parameters:
+    orientation     +1 if the face goes counterclockwise, -1 if clockwise.
+Returns:
+    True if the face is convex, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool FaceTriangulator::ProjectedFaceIsConvex(float orientation) const
+{
+    size_t numCorners = _projectedCorners.size();
+    for (size_t cornerIndex = 0; cornerIndex < numCorners; cornerIndex++)
+    {
+        size_t prevIndex = (cornerIndex + numCorners - 1) % numCorners;
+        const glm::vec2 &prevCorner = _projectedCorners[prevIndex];
+        const glm::vec2 &thisCorner = _projectedCorners[cornerIndex];
+        const glm::vec2 &nextCorner = _projectedCorners[(cornerIndex + 1) % numCorners];
+        if (Cross2D(thisCorner - prevCorner, nextCorner - thisCorner) * orientation < 0.0f)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Ear clipping for concave faces.  An "ear" is a corner that turns the same way as the face
+    and whose triangle (with its two neighbors) has no other corner in it.  Cutting off an ear
+    leaves a smaller face, and every simple polygon has at least two ears, so this repeats
+    until only a triangle is left.
+
+    Note: A face that crosses over itself may have no ears.  If that happens, the first
+    remaining corner is cut off anyway so that the face still comes out as N - 2 triangles
+    (some of which will be wrong, but so is the face).
+Parameters:
+    orientation         +1 if the face goes counterclockwise, -1 if clockwise.
+    putTrianglesHere    Gets 3 corner numbers per triangle.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+void FaceTriangulator::ClipEars(float orientation, std::vector<unsigned int> *putTrianglesHere)
+{
+    size_t numCorners = _projectedCorners.size();
+    _remainingCorners.resize(numCorners);
+    for (size_t cornerIndex = 0; cornerIndex < numCorners; cornerIndex++)
+    {
+        _remainingCorners[cornerIndex] = static_cast<unsigned int>(cornerIndex);
+    }
+
+    while (_remainingCorners.size() > 3)
+    {
+        size_t numRemaining = _remainingCorners.size();
+        size_t earIndex = 0;
+        for (size_t remainingIndex = 0; remainingIndex < numRemaining; remainingIndex++)
+        {
+            size_t prevIndex = (remainingIndex + numRemaining - 1) % numRemaining;
+            size_t nextIndex = (remainingIndex + 1) % numRemaining;
+            unsigned int prevCorner = _remainingCorners[prevIndex];
+            unsigned int thisCorner = _remainingCorners[remainingIndex];
+            unsigned int nextCorner = _remainingCorners[nextIndex];
+            const glm::vec2 &a = _projectedCorners[prevCorner];
+            const glm::vec2 &b = _projectedCorners[thisCorner];
+            const glm::vec2 &c = _projectedCorners[nextCorner];
+            if (Cross2D(b - a, c - b) * orientation <= 0.0f)
+            {
+                // turns the wrong way (or not at all), so cutting here would leave the face
+                continue;
+            }
+
+            bool isEar = true;
+            for (size_t otherIndex = 0; otherIndex < numRemaining && isEar; otherIndex++)
+            {
+                unsigned int otherCorner = _remainingCorners[otherIndex];
+                const glm::vec2 &point = _projectedCorners[otherCorner];
+                if (otherCorner == prevCorner || otherCorner == thisCorner ||
+                    otherCorner == nextCorner || point == a || point == b || point == c)
+                {
+                    continue;
+                }
+                isEar = !PointIsInTriangle(point, a, b, c, orientation);
+            }
+
+            if (isEar)
+            {
+                earIndex = remainingIndex;
+                break;
+            }
+        }
+
+        size_t prevIndex = (earIndex + numRemaining - 1) % numRemaining;
+        size_t nextIndex = (earIndex + 1) % numRemaining;
+        putTrianglesHere->push_back(_remainingCorners[prevIndex]);
+        putTrianglesHere->push_back(_remainingCorners[earIndex]);
+        putTrianglesHere->push_back(_remainingCorners[nextIndex]);
+        _remainingCorners.erase(_remainingCorners.begin() + earIndex);
+    }
+
+    putTrianglesHere->push_back(_remainingCorners[0]);
+    putTrianglesHere->push_back(_remainingCorners[1]);
+    putTrianglesHere->push_back(_remainingCorners[2]);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+#include "glm/vec2.hpp"
+#include "glm/vec3.hpp"
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Cuts a face (a flat polygon) with any number of corners into triangles.  Convex faces,
+    which is nearly all of them, are cut into a fan.  Concave faces are cut by ear clipping,
+    which is slower, but never puts a triangle outside of the face.
+
+    Note: A face with N corners always becomes N - 2 triangles, whichever way it is cut, so the
+    caller can size its output before the face is looked at.
+
+    Also Note: The triangulator keeps its scratch collections between faces, so once it has
+    seen the biggest face it never allocates again.  Keep one per thread.
+-----------------------------------------------------------------------------------------------*/
+class FaceTriangulator
+{
+public:
+    void Triangulate(const glm::vec3 *corners, size_t numCorners,
+        std::vector<unsigned int> *putTrianglesHere);
+
+private:
+    void ProjectCorners(const glm::vec3 *corners, size_t numCorners);
+    bool ProjectedFaceIsConvex(float orientation) const;
+    void ClipEars(float orientation, std::vector<unsigned int> *putTrianglesHere);
+
+    // the corners flattened onto the face's plane (well, onto whichever of XY, YZ, or ZX it is
+    // closest to)
+    std::vector<glm::vec2> _projectedCorners;
+
+    // ear clipping only: corners that haven't been cut off yet, in order
+    std::vector<unsigned int> _remainingCorners;
+};
@@ -0,0 +1,416 @@
+#include "FastNumberParse.h"
+
+// for strtof(...) in the rare case that the fast paths can't guarantee correct rounding
+#include <stdlib.h>
+
+// for memcpy(...)
+#include <string.h>
+
+// x64 always has SSE2, and VS2012+ defaults to /arch:SSE2 for x86 (_M_IX86_FP == 2)
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define FAST_NUMBER_PARSE_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// a uint64 can hold any 19-digit decimal number
+static const int MAX_EXACT_MANTISSA_DIGITS = 19;
+
+// integers up to 2^24 are exact in a float, and so are powers of 10 up to 10^10
+static const unsigned long long MAX_EXACT_FLOAT_MANTISSA = 1ull << 24;
+static const int MAX_EXACT_FLOAT_POWER_OF_10 = 10;
+
+// likewise, 2^53 and 10^22 for doubles
+static const unsigned long long MAX_EXACT_DOUBLE_MANTISSA = 1ull << 53;
+static const int MAX_EXACT_DOUBLE_POWER_OF_10 = 22;
+
+// the fallback builds a "<digits>e<exponent>" string on the stack for strtof(...)
+// Note: A float only needs 9 significant digits to round trip, and anything past ~112 digits
+// cannot change the rounding of a float, so truncating beyond this is harmless.
+static const int MAX_FALLBACK_DIGITS = 120;
+
+static const float EXACT_FLOAT_POWERS_OF_10[] =
+{
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f,
+};
+
+static const double EXACT_DOUBLE_POWERS_OF_10[] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+    1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Skips spaces and tabs.  Newlines are not skipped because the loader works one line at a
+    time and the line range never includes them.
+Parameters:
+    begin   Self-explanatory.
+    end     Pointer to one past the last character that may be read.
+Returns:
+    Pointer to the first character that is not a space or tab, or end.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static const char *SkipSpaces(const char *begin, const char *end)
+{
+    while (begin < end && (*begin == ' ' || *begin == '\t'))
+    {
+        begin++;
+    }
+    return begin;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Counts how many characters in a row are the digits '0' through '9'.
+
+    Note: With SSE2, 16 characters are checked at once.  A byte is a digit if (byte - '0'),
+    taken as unsigned, is <= 9.  SSE2 has no unsigned byte compare, but max(x, 9) == 9 is the
+    same thing.  The first non-digit is then the lowest clear bit of the movemask.
+Parameters:
+    begin   Self-explanatory.
+    end     Pointer to one past the last character that may be read.
+Returns:
+    See description.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static size_t CountDigits(const char *begin, const char *end)
+{
+    const char *current = begin;
+
+#ifdef FAST_NUMBER_PARSE_SSE2
+    const __m128i asciiZero = _mm_set1_epi8('0');
+    const __m128i nine = _mm_set1_epi8(9);
+    while (end - current >= 16)
+    {
+        __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(current));
+        __m128i values = _mm_sub_epi8(chars, asciiZero);
+        __m128i isDigit = _mm_cmpeq_epi8(_mm_max_epu8(values, nine), nine);
+        unsigned int notDigitMask = ~static_cast<unsigned int>(_mm_movemask_epi8(isDigit)) & 0xFFFF;
+        if (notDigitMask != 0)
+        {
+#ifdef _MSC_VER
+            unsigned long firstNotDigit = 0;
+            _BitScanForward(&firstNotDigit, notDigitMask);
+#else
+            unsigned int firstNotDigit = __builtin_ctz(notDigitMask);
+#endif
+            return (current - begin) + firstNotDigit;
+        }
+        current += 16;
+    }
+#endif
+
+    // the tail (or everything, without SSE2)
+    while (current < end && static_cast<unsigned char>(*current - '0') <= 9)
+    {
+        current++;
+    }
+    return current - begin;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Parses a floating point number of the form [+-]digits[.digits][(e|E)[+-]digits].  The
+    result is correctly rounded (identical to a conforming strtof(...) in the "C" locale).
+
+    Note: Almost every number in a Blender export (6 decimal places, |value| < 16) takes the
+    first fast path, where both the mantissa and the power of 10 are exact floats, so a single
+    float multiply or divide gives the correctly rounded result.  The second fast path does the
+    same with doubles, and then checks that rounding the double to a float did not land
+    exactly on a tie between 2 floats, which is the only way that rounding twice can go wrong.
+    Everything else is handed to strtof(...) as "<digits>e<exponent>", which has no decimal
+    point and so does not care about the locale.
+Parameters:
+    begin           Self-explanatory.
+    end             Pointer to one past the last character that may be read.
+    putValueHere    Self-explanatory.
+Returns:
+    Pointer to the first character after the number, or null if there is no number.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+const char *ParseFloat(const char *begin, const char *end, float *putValueHere)
+{
+    *putValueHere = 0.0f;
+    const char *current = SkipSpaces(begin, end);
+
+    bool isNegative = false;
+    if (current < end && (*current == '-' || *current == '+'))
+    {
+        isNegative = (*current == '-');
+        current++;
+    }
+
+    // integer part
+    const char *integerDigits = current;
+    size_t numIntegerDigits = CountDigits(current, end);
+    current += numIntegerDigits;
+
+    // fractional part
+    const char *fractionDigits = current;
+    size_t numFractionDigits = 0;
+    if (current < end && *current == '.')
+    {
+        fractionDigits = current + 1;
+        numFractionDigits = CountDigits(fractionDigits, end);
+        current = fractionDigits + numFractionDigits;
+    }
+
+    if (numIntegerDigits == 0 && numFractionDigits == 0)
+    {
+        // not a number
+        return 0;
+    }
+
+    // exponent
+    // Note: An 'e' that isn't followed by digits is not part of the number (same as strtof).
+    int exponent = 0;
+    if (current < end && (*current == 'e' || *current == 'E'))
+    {
+        const char *exponentCurrent = current + 1;
+        bool exponentIsNegative = false;
+        if (exponentCurrent < end && (*exponentCurrent == '-' || *exponentCurrent == '+'))
+        {
+            exponentIsNegative = (*exponentCurrent == '-');
+            exponentCurrent++;
+        }
+
+        size_t numExponentDigits = CountDigits(exponentCurrent, end);
+        if (numExponentDigits > 0)
+        {
+            for (size_t digitIndex = 0; digitIndex < numExponentDigits; digitIndex++)
+            {
+                // anything this big is inf or 0 anyway, so just stop growing
+                if (exponent < 100000)
+                {
+                    exponent = exponent * 10 + (exponentCurrent[digitIndex] - '0');
+                }
+            }
+            exponent = exponentIsNegative ? -exponent : exponent;
+            current = exponentCurrent + numExponentDigits;
+        }
+    }
+
+    // gather the significant digits into an integer
+    // Note: Leading zeros are not significant.  Every fractional digit moves the decimal point
+    // 1 place to the left.  If there are too many significant digits to fit, then the dropped
+    // ones move the decimal point to the right.
+    unsigned long long mantissa = 0;
+    int numSignificantDigits = 0;
+    int numDroppedDigits = 0;
+    bool droppedNonZeroDigit = false;
+    const char *digitRanges[2] = { integerDigits, fractionDigits };
+    size_t digitCounts[2] = { numIntegerDigits, numFractionDigits };
+    for (int rangeIndex = 0; rangeIndex < 2; rangeIndex++)
+    {
+        for (size_t digitIndex = 0; digitIndex < digitCounts[rangeIndex]; digitIndex++)
+        {
+            int digit = digitRanges[rangeIndex][digitIndex] - '0';
+            if (numSignificantDigits < MAX_EXACT_MANTISSA_DIGITS)
+            {
+                mantissa = mantissa * 10 + digit;
+                if (mantissa != 0)
+                {
+                    numSignificantDigits++;
+                }
+            }
+            else
+            {
+                numDroppedDigits++;
+                droppedNonZeroDigit = droppedNonZeroDigit || (digit != 0);
+            }
+        }
+    }
+    int powerOf10 = exponent - static_cast<int>(numFractionDigits) + numDroppedDigits;
+
+    if (mantissa == 0)
+    {
+        *putValueHere = isNegative ? -0.0f : 0.0f;
+        return current;
+    }
+
+    if (!droppedNonZeroDigit)
+    {
+        if (mantissa <= MAX_EXACT_FLOAT_MANTISSA &&
+            powerOf10 >= -MAX_EXACT_FLOAT_POWER_OF_10 && powerOf10 <= MAX_EXACT_FLOAT_POWER_OF_10)
+        {
+            float value = static_cast<float>(mantissa);
+            if (powerOf10 < 0)
+            {
+                value /= EXACT_FLOAT_POWERS_OF_10[-powerOf10];
+            }
+            else
+            {
+                value *= EXACT_FLOAT_POWERS_OF_10[powerOf10];
+            }
+            *putValueHere = isNegative ? -value : value;
+            return current;
+        }
+
+        if (mantissa <= MAX_EXACT_DOUBLE_MANTISSA &&
+            powerOf10 >= -MAX_EXACT_DOUBLE_POWER_OF_10 &&
+            powerOf10 <= MAX_EXACT_DOUBLE_POWER_OF_10)
+        {
+            double value = static_cast<double>(mantissa);
+            if (powerOf10 < 0)
+            {
+                value /= EXACT_DOUBLE_POWERS_OF_10[-powerOf10];
+            }
+            else
+            {
+                value *= EXACT_DOUBLE_POWERS_OF_10[powerOf10];
+            }
+
+            // a double has 29 more mantissa bits than a float; if those are exactly "1000...0"
+            // then the double is a tie between 2 floats and rounding again may go the wrong way
+            // Note: The value is in [1e-22, 9e37] here, so it is always a normal float.
+            unsigned long long valueBits = 0;
+            memcpy(&valueBits, &value, sizeof(value));
+            if ((valueBits & 0x1FFFFFFFull) != 0x10000000ull)
+            {
+                float floatValue = static_cast<float>(value);
+                *putValueHere = isNegative ? -floatValue : floatValue;
+                return current;
+            }
+        }
+    }
+
+    // slow path: let the C runtime do it, but without a decimal point
+    char digitBuffer[MAX_FALLBACK_DIGITS + 16];
+    int numBufferChars = 0;
+    int numFallbackDroppedDigits = 0;
+    bool skippingLeadingZeros = true;
+    for (int rangeIndex = 0; rangeIndex < 2; rangeIndex++)
+    {
+        for (size_t digitIndex = 0; digitIndex < digitCounts[rangeIndex]; digitIndex++)
+        {
+            char digitChar = digitRanges[rangeIndex][digitIndex];
+            skippingLeadingZeros = skippingLeadingZeros && (digitChar == '0');
+            if (skippingLeadingZeros)
+            {
+                continue;
+            }
+
+            if (numBufferChars < MAX_FALLBACK_DIGITS)
+            {
+                digitBuffer[numBufferChars++] = digitChar;
+            }
+            else
+            {
+                numFallbackDroppedDigits++;
+            }
+        }
+    }
+
+    int fallbackPowerOf10 = exponent - static_cast<int>(numFractionDigits) +
+        numFallbackDroppedDigits;
+    digitBuffer[numBufferChars++] = 'e';
+
+    // itoa(...) is not standard, so write the exponent by hand (backwards, then reverse)
+    if (fallbackPowerOf10 < 0)
+    {
+        digitBuffer[numBufferChars++] = '-';
+        fallbackPowerOf10 = -fallbackPowerOf10;
+    }
+    int exponentStart = numBufferChars;
+    do
+    {
+        digitBuffer[numBufferChars++] = static_cast<char>('0' + (fallbackPowerOf10 % 10));
+        fallbackPowerOf10 /= 10;
+    } while (fallbackPowerOf10 > 0);
+    for (int left = exponentStart, right = numBufferChars - 1; left < right; left++, right--)
+    {
+        char temp = digitBuffer[left];
+        digitBuffer[left] = digitBuffer[right];
+        digitBuffer[right] = temp;
+    }
+    digitBuffer[numBufferChars] = 0;
+
+    float value = strtof(digitBuffer, 0);
+    *putValueHere = isNegative ? -value : value;
+    return current;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    The guts of both ParseUnsignedInt(...)s.
+
+    Note: Values that do not fit are treated as "no number" rather than quietly wrapping
+    around, because a wrapped vertex index would silently point at the wrong vertex.
+Parameters:
+    begin           Self-explanatory.
+    end             Pointer to one past the last character that may be read.
+    putValueHere    Self-explanatory.
+Returns:
+    Pointer to the first character after the number, or null if there is no number or it is
+    too big for UINT_TYPE.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+template<typename UINT_TYPE>
+static const char *ParseUnsignedDecimal(const char *begin, const char *end,
+    UINT_TYPE *putValueHere)
+{
+    const char *current = SkipSpaces(begin, end);
+    size_t numDigits = CountDigits(current, end);
+    if (numDigits == 0)
+    {
+        *putValueHere = 0;
+        return 0;
+    }
+
+    static const UINT_TYPE MAX_BEFORE_MULTIPLY = static_cast<UINT_TYPE>(~UINT_TYPE(0)) / 10;
+    static const UINT_TYPE MAX_LAST_DIGIT = static_cast<UINT_TYPE>(~UINT_TYPE(0)) % 10;
+
+    UINT_TYPE value = 0;
+    for (size_t digitIndex = 0; digitIndex < numDigits; digitIndex++)
+    {
+        UINT_TYPE digit = static_cast<UINT_TYPE>(current[digitIndex] - '0');
+        if (value > MAX_BEFORE_MULTIPLY ||
+            (value == MAX_BEFORE_MULTIPLY && digit > MAX_LAST_DIGIT))
+        {
+            *putValueHere = 0;
+            return 0;
+        }
+        value = value * 10 + digit;
+    }
+
+    *putValueHere = value;
+    return current + numDigits;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Parses an unsigned decimal integer.  See ParseUnsignedDecimal(...).
+Parameters:
+    begin           Self-explanatory.
+    end             Pointer to one past the last character that may be read.
+    putValueHere    Self-explanatory.
+Returns:
+    Pointer to the first character after the number, or null if there is no number or it
+    doesn't fit.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+const char *ParseUnsignedInt(const char *begin, const char *end, unsigned int *putValueHere)
+{
+    return ParseUnsignedDecimal(begin, end, putValueHere);
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Parses an unsigned decimal integer.  See ParseUnsignedDecimal(...).
+Parameters:
+    begin           Self-explanatory.
+    end             Pointer to one past the last character that may be read.
+    putValueHere    Self-explanatory.
+Returns:
+    Pointer to the first character after the number, or null if there is no number or it
+    doesn't fit.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+const char *ParseUnsignedInt(const char *begin, const char *end,
+    unsigned long long *putValueHere)
+{
+    return ParseUnsignedDecimal(begin, end, putValueHere);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Number parsing for the .obj loader.  These replace sscanf(...), which is slow (it re-scans
+    the whole string every call on some runtimes), locale-sensitive (a German locale expects
+    "0,5"), and needs a null-terminated string.
+
+    All functions work on a [begin, end) range that does not need to be null terminated, skip
+    leading spaces and tabs, and return a pointer to the first character after the number.  If
+    there is no number at the start of the range (or an integer is too big for its type), they
+    return null and set the value to 0.
+-----------------------------------------------------------------------------------------------*/
+
+const char *ParseFloat(const char *begin, const char *end, float *putValueHere);
+const char *ParseUnsignedInt(const char *begin, const char *end, unsigned int *putValueHere);
+const char *ParseUnsignedInt(const char *begin, const char *end,
+    unsigned long long *putValueHere);
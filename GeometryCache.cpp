@@ -0,0 +1,484 @@
+#include "GeometryCache.h"
+
+#include <fstream>
+#include <atomic>
+#include <thread>
+
+// for memcpy(...) and memcmp(...)
+#include <string.h>
+
+// for remove(...) and rename(...)
+#include <stdio.h>
+
+#include "MemoryMappedFile.h"
+
+// "GEOCACHE" in the first 8 bytes so that a random file is never mistaken for a cache
+static const char CACHE_MAGIC[8] = { 'G', 'E', 'O', 'C', 'A', 'C', 'H', 'E' };
+
+// bump this whenever the file layout (or MyVertex, or the parse output) changes
+// 2: indices past 65535 no longer wrap
+// 3: welded element indices
+// 4: objects in file order rather than name order
+// 5: stitched line strips flag in place of padding
+// 6: n-gons are triangulated instead of cut off after their first triangle
+static const unsigned int CACHE_FORMAT_VERSION = 6;
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    The first thing in the cache file.
+-----------------------------------------------------------------------------------------------*/
+struct GeometryCacheHeader
+{
+    char _magic[8];
+    unsigned int _formatVersion;
+    unsigned int _vertexSizeBytes;
+    unsigned int _welded;
+    unsigned int _stitchedLines;
+    unsigned long long _sourceSize;
+    unsigned long long _sourceHash;
+    unsigned long long _numObjects;
+};
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Precedes each object in the cache file.  It is followed by the name's characters (no null
+    terminator), then by the raw MyVertex array, and then by the raw 32-bit index array (if
+    welded).
+-----------------------------------------------------------------------------------------------*/
+struct GeometryCacheObjectHeader
+{
+    unsigned long long _nameLength;
+    unsigned long long _numVerts;
+    unsigned long long _numIndices;
+    unsigned int _drawStyle;
+    unsigned int _indexType;
+};
+
+// "OBJINDEX" for the object index file
+static const char INDEX_MAGIC[8] = { 'O', 'B', 'J', 'I', 'N', 'D', 'E', 'X' };
+
+// bump this whenever the layout of the index file changes
+static const unsigned int INDEX_FORMAT_VERSION = 1;
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    The first thing in the object index file.
+-----------------------------------------------------------------------------------------------*/
+struct ObjectIndexHeader
+{
+    char _magic[8];
+    unsigned int _formatVersion;
+    unsigned int _padding;
+    unsigned long long _sourceSize;
+    unsigned long long _sourceHash;
+    unsigned long long _numEntries;
+};
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Precedes each entry in the object index file.  It is followed by the name's characters (no
+    null terminator).
+-----------------------------------------------------------------------------------------------*/
+struct ObjectIndexEntryHeader
+{
+    unsigned long long _nameLength;
+    unsigned long long _textBegin;
+    unsigned long long _textEnd;
+    unsigned long long _positionsBefore;
+    unsigned long long _normalsBefore;
+};
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Makes a temporary name for a file that is about to be written.  Every call gets a different
+    name, so threads that write the same file at once (such as a scene manifest that lists an
+    .obj file twice; see SceneManifest) don't write into each other's temporary file.  The
+    last rename wins, and both wrote the same thing anyway.
+Parameters:
+    finalPath   What the file will be called once it is finished.
+Returns:
+    finalPath with the thread and a per-process counter tacked on, and then ".tmp".
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static std::string TempPathFor(const std::string &finalPath)
+{
+    static std::atomic<unsigned long long> nextTempFileNumber(0);
+    size_t threadHash = std::hash<std::thread::id>()(std::this_thread::get_id());
+    return finalPath + "." + std::to_string(threadHash) + "." +
+        std::to_string(nextTempFileNumber++) + ".tmp";
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Closes a file that was written under a temporary name and renames it to its real name so
+    that a crash part way through never leaves a truncated file behind.
+Parameters:
+    file        The open temporary file.
+    tempPath    Its name.
+    finalPath   What it should be called.
+Returns:
+    True if everything was written and the file was renamed, otherwise false (and the
+    temporary file is deleted).
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static bool FinishTempFile(std::ofstream *file, const std::string &tempPath,
+    const std::string &finalPath)
+{
+    file->close();
+    if (file->fail())
+    {
+        remove(tempPath.c_str());
+        return false;
+    }
+
+    // rename(...) won't replace an existing file on Windows
+    remove(finalPath.c_str());
+    if (rename(tempPath.c_str(), finalPath.c_str()) != 0)
+    {
+        remove(tempPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Where the cache for a particular .obj file lives.
+Parameters:
+    objFilePath     Self-explanatory.
+Returns:
+    The .obj file's path with ".geocache" tacked on the end.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+std::string GeometryCache::CachePathFor(const std::string &objFilePath)
+{
+    return objFilePath + ".geocache";
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    A fast, non-cryptographic 64-bit hash of a block of memory.  This is FNV-1a, but it eats
+    8 bytes at a time instead of 1 so that hashing a large .obj file costs far less than
+    parsing it.
+Parameters:
+    data        Self-explanatory.
+    numBytes    Self-explanatory.
+Returns:
+    The hash.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+unsigned long long GeometryCache::HashBytes(const char *data, size_t numBytes)
+{
+    static const unsigned long long FNV_OFFSET_BASIS = 14695981039346656037ull;
+    static const unsigned long long FNV_PRIME = 1099511628211ull;
+
+    unsigned long long hash = FNV_OFFSET_BASIS ^ numBytes;
+    size_t byteIndex = 0;
+    for (; byteIndex + sizeof(unsigned long long) <= numBytes;
+        byteIndex += sizeof(unsigned long long))
+    {
+        // memcpy(...) because the data may not be 8-byte aligned
+        unsigned long long word = 0;
+        memcpy(&word, data + byteIndex, sizeof(word));
+        hash = (hash ^ word) * FNV_PRIME;
+
+        // fold the high bits back down; FNV's multiply only pushes information upward
+        hash ^= hash >> 29;
+    }
+
+    for (; byteIndex < numBytes; byteIndex++)
+    {
+        hash = (hash ^ static_cast<unsigned char>(data[byteIndex])) * FNV_PRIME;
+    }
+
+    return hash;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Loads the geometry from a cache file if, and only if, the cache was made from an .obj file
+    with the same size and hash, with the same welding option, by a program with the same cache
+    format.
+
+    Note: The cache file is memory-mapped, so the only copy is from the mapping straight into
+    each object's vertex collection.
+Parameters:
+    cachePath   From CachePathFor(...).
+    sourceSize  The size of the .obj file in bytes.
+    sourceHash  From HashBytes(...) on the .obj file's contents.
+    welded      True if the caller wants welded geometry (see VertexWeld.h).
+    stitchedLines   True if the caller wants lines stitched into strips (see LineStitch.h).
+    putDataHere Only modified if the whole cache was valid, and then whatever was in it is
+                replaced by the cached objects (like BlenderLoad::LoadObj(...), which clears
+                it first).
+Returns:
+    True if the geometry was loaded from the cache, otherwise false (missing, stale, or
+    corrupt).
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool GeometryCache::Read(const std::string &cachePath, unsigned long long sourceSize,
+    unsigned long long sourceHash, bool welded, bool stitchedLines,
+    BlenderLoad::GEOMETRY_DATA_BY_NAME *putDataHere)
+{
+    MemoryMappedFile cacheFile;
+    if (!cacheFile.Open(cachePath) || cacheFile.Size() < sizeof(GeometryCacheHeader))
+    {
+        return false;
+    }
+
+    const char *current = cacheFile.Data();
+    const char *end = cacheFile.Data() + cacheFile.Size();
+
+    GeometryCacheHeader header;
+    memcpy(&header, current, sizeof(header));
+    current += sizeof(header);
+    if (memcmp(header._magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+        header._formatVersion != CACHE_FORMAT_VERSION ||
+        header._vertexSizeBytes != sizeof(MyVertex) ||
+        header._welded != (welded ? 1u : 0u) ||
+        header._stitchedLines != (stitchedLines ? 1u : 0u) ||
+        header._sourceSize != sourceSize ||
+        header._sourceHash != sourceHash)
+    {
+        return false;
+    }
+
+    // read into a temporary so that a truncated file doesn't leave half the objects behind
+    BlenderLoad::GEOMETRY_DATA_BY_NAME cachedData;
+    for (unsigned long long objectIndex = 0; objectIndex < header._numObjects; objectIndex++)
+    {
+        GeometryCacheObjectHeader objectHeader;
+        if (static_cast<size_t>(end - current) < sizeof(objectHeader))
+        {
+            return false;
+        }
+        memcpy(&objectHeader, current, sizeof(objectHeader));
+        current += sizeof(objectHeader);
+
+        unsigned long long numVertBytes = objectHeader._numVerts * sizeof(MyVertex);
+        unsigned long long numIndexBytes = objectHeader._numIndices * sizeof(unsigned int);
+        unsigned long long numBytesLeft = static_cast<unsigned long long>(end - current);
+        if (numBytesLeft < objectHeader._nameLength ||
+            numBytesLeft - objectHeader._nameLength < numVertBytes ||
+            numBytesLeft - objectHeader._nameLength - numVertBytes < numIndexBytes)
+        {
+            return false;
+        }
+
+        std::string name(current, static_cast<size_t>(objectHeader._nameLength));
+        current += objectHeader._nameLength;
+
+        GeometryData &geometryData = cachedData.Geometry(cachedData.Add(name));
+        geometryData._drawStyle = objectHeader._drawStyle;
+        geometryData._verts.resize(static_cast<size_t>(objectHeader._numVerts));
+        if (numVertBytes > 0)
+        {
+            // MyVertex is plain data (glm vectors), so a straight copy is fine
+            memcpy(static_cast<void *>(geometryData._verts.data()), current,
+                static_cast<size_t>(numVertBytes));
+        }
+        current += numVertBytes;
+
+        geometryData._indexType = objectHeader._indexType;
+        geometryData._indices.resize(static_cast<size_t>(objectHeader._numIndices));
+        if (numIndexBytes > 0)
+        {
+            memcpy(geometryData._indices.data(), current, static_cast<size_t>(numIndexBytes));
+        }
+        current += numIndexBytes;
+    }
+
+    putDataHere->Swap(cachedData);
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Saves the geometry to a cache file.  The file is written under a temporary name and then
+    renamed so that a crash part way through never leaves a truncated cache behind.
+Parameters:
+    cachePath   From CachePathFor(...).
+    sourceSize  The size of the .obj file in bytes.
+    sourceHash  From HashBytes(...) on the .obj file's contents.
+    welded      True if the geometry was welded (see VertexWeld.h).
+    stitchedLines   True if its lines were stitched into strips (see LineStitch.h).
+    geometry    The output of BlenderLoad::LoadObj(...) for that .obj file.
+Returns:
+    True if the cache was written, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool GeometryCache::Write(const std::string &cachePath, unsigned long long sourceSize,
+    unsigned long long sourceHash, bool welded, bool stitchedLines,
+    const BlenderLoad::GEOMETRY_DATA_BY_NAME &geometry)
+{
+    std::string tempPath = TempPathFor(cachePath);
+    std::ofstream cacheFile(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!cacheFile.is_open())
+    {
+        return false;
+    }
+
+    GeometryCacheHeader header;
+    memcpy(header._magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header._formatVersion = CACHE_FORMAT_VERSION;
+    header._vertexSizeBytes = sizeof(MyVertex);
+    header._welded = welded ? 1 : 0;
+    header._stitchedLines = stitchedLines ? 1 : 0;
+    header._sourceSize = sourceSize;
+    header._sourceHash = sourceHash;
+    header._numObjects = geometry.Size();
+    cacheFile.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    for (GeometryRegistry::HANDLE handle = 0; handle < geometry.Size(); handle++)
+    {
+        const std::string &name = geometry.Name(handle);
+        const GeometryData &geometryData = geometry.Geometry(handle);
+
+        GeometryCacheObjectHeader objectHeader;
+        objectHeader._nameLength = name.length();
+        objectHeader._numVerts = geometryData._verts.size();
+        objectHeader._numIndices = geometryData._indices.size();
+        objectHeader._drawStyle = geometryData._drawStyle;
+        objectHeader._indexType = geometryData._indexType;
+        cacheFile.write(reinterpret_cast<const char *>(&objectHeader), sizeof(objectHeader));
+        cacheFile.write(name.data(), name.length());
+        cacheFile.write(reinterpret_cast<const char *>(geometryData._verts.data()),
+            geometryData._verts.size() * sizeof(MyVertex));
+        cacheFile.write(reinterpret_cast<const char *>(geometryData._indices.data()),
+            geometryData._indices.size() * sizeof(unsigned int));
+    }
+
+    return FinishTempFile(&cacheFile, tempPath, cachePath);
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Where the object index for a particular .obj file lives.
+Parameters:
+    objFilePath     Self-explanatory.
+Returns:
+    The .obj file's path with ".objindex" tacked on the end.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+std::string GeometryCache::IndexPathFor(const std::string &objFilePath)
+{
+    return objFilePath + ".objindex";
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Loads an object index if, and only if, it was made from an .obj file with the same size and
+    hash by a program with the same index format.
+Parameters:
+    indexPath       From IndexPathFor(...).
+    sourceSize      The size of the .obj file in bytes.
+    sourceHash      From HashBytes(...) on the .obj file's contents.
+    putIndexHere    Only modified if the whole index was valid.
+Returns:
+    True if the index was loaded, otherwise false (missing, stale, or corrupt).
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool GeometryCache::ReadObjectIndex(const std::string &indexPath, unsigned long long sourceSize,
+    unsigned long long sourceHash, BlenderLoad::OBJECT_INDEX *putIndexHere)
+{
+    MemoryMappedFile indexFile;
+    if (!indexFile.Open(indexPath) || indexFile.Size() < sizeof(ObjectIndexHeader))
+    {
+        return false;
+    }
+
+    const char *current = indexFile.Data();
+    const char *end = indexFile.Data() + indexFile.Size();
+
+    ObjectIndexHeader header;
+    memcpy(&header, current, sizeof(header));
+    current += sizeof(header);
+    if (memcmp(header._magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 ||
+        header._formatVersion != INDEX_FORMAT_VERSION ||
+        header._sourceSize != sourceSize ||
+        header._sourceHash != sourceHash)
+    {
+        return false;
+    }
+
+    BlenderLoad::OBJECT_INDEX cachedIndex;
+    for (unsigned long long entryIndex = 0; entryIndex < header._numEntries; entryIndex++)
+    {
+        ObjectIndexEntryHeader entryHeader;
+        if (static_cast<size_t>(end - current) < sizeof(entryHeader))
+        {
+            return false;
+        }
+        memcpy(&entryHeader, current, sizeof(entryHeader));
+        current += sizeof(entryHeader);
+
+        // the byte ranges are used to index into the .obj file, so don't trust them blindly
+        if (static_cast<unsigned long long>(end - current) < entryHeader._nameLength ||
+            entryHeader._textBegin > entryHeader._textEnd ||
+            entryHeader._textEnd > sourceSize)
+        {
+            return false;
+        }
+
+        BlenderLoad::ObjectIndexEntry entry;
+        entry._name.assign(current, static_cast<size_t>(entryHeader._nameLength));
+        entry._textBegin = entryHeader._textBegin;
+        entry._textEnd = entryHeader._textEnd;
+        entry._positionsBefore = entryHeader._positionsBefore;
+        entry._normalsBefore = entryHeader._normalsBefore;
+        cachedIndex.push_back(entry);
+        current += entryHeader._nameLength;
+    }
+
+    putIndexHere->swap(cachedIndex);
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Saves an object index.  Written like Write(...), under a temporary name first.
+Parameters:
+    indexPath   From IndexPathFor(...).
+    sourceSize  The size of the .obj file in bytes.
+    sourceHash  From HashBytes(...) on the .obj file's contents.
+    objectIndex The object index for that .obj file.
+Returns:
+    True if the index was written, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool GeometryCache::WriteObjectIndex(const std::string &indexPath, unsigned long long sourceSize,
+    unsigned long long sourceHash, const BlenderLoad::OBJECT_INDEX &objectIndex)
+{
+    std::string tempPath = TempPathFor(indexPath);
+    std::ofstream indexFile(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!indexFile.is_open())
+    {
+        return false;
+    }
+
+    ObjectIndexHeader header;
+    memcpy(header._magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header._formatVersion = INDEX_FORMAT_VERSION;
+    header._padding = 0;
+    header._sourceSize = sourceSize;
+    header._sourceHash = sourceHash;
+    header._numEntries = objectIndex.size();
+    indexFile.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    for (size_t entryIndex = 0; entryIndex < objectIndex.size(); entryIndex++)
+    {
+        const BlenderLoad::ObjectIndexEntry &entry = objectIndex[entryIndex];
+
+        ObjectIndexEntryHeader entryHeader;
+        entryHeader._nameLength = entry._name.length();
+        entryHeader._textBegin = entry._textBegin;
+        entryHeader._textEnd = entry._textEnd;
+        entryHeader._positionsBefore = entry._positionsBefore;
+        entryHeader._normalsBefore = entry._normalsBefore;
+        indexFile.write(reinterpret_cast<const char *>(&entryHeader), sizeof(entryHeader));
+        indexFile.write(entry._name.data(), entry._name.length());
+    }
+
+    return FinishTempFile(&indexFile, tempPath, indexPath);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include "BlenderLoad.h"
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Saves and restores the output of BlenderLoad::LoadObj(...) as a binary file next to the .obj
+    file so that later runs can skip text parsing entirely.
+
+    The cache is invalidated by the size and a hash of the .obj file's contents, by a change in
+    the welding or stitching options, and by a format version that must be bumped whenever the
+    layout of the cache or of MyVertex changes.  It is written in the machine's native byte
+    order because it is only ever read back by the same program on the same machine.
+-----------------------------------------------------------------------------------------------*/
+class GeometryCache
+{
+public:
+    static std::string CachePathFor(const std::string &objFilePath);
+    static unsigned long long HashBytes(const char *data, size_t numBytes);
+
+    static bool Read(const std::string &cachePath, unsigned long long sourceSize,
+        unsigned long long sourceHash, bool welded, bool stitchedLines,
+        BlenderLoad::GEOMETRY_DATA_BY_NAME *putDataHere);
+    static bool Write(const std::string &cachePath, unsigned long long sourceSize,
+        unsigned long long sourceHash, bool welded, bool stitchedLines,
+        const BlenderLoad::GEOMETRY_DATA_BY_NAME &geometry);
+
+    // the object index (see BlenderLoad::GetObjectIndex(...)) is kept in a separate file and
+    // is invalidated in the same way
+    static std::string IndexPathFor(const std::string &objFilePath);
+    static bool ReadObjectIndex(const std::string &indexPath, unsigned long long sourceSize,
+        unsigned long long sourceHash, BlenderLoad::OBJECT_INDEX *putIndexHere);
+    static bool WriteObjectIndex(const std::string &indexPath, unsigned long long sourceSize,
+        unsigned long long sourceHash, const BlenderLoad::OBJECT_INDEX &objectIndex);
+};
@@ -5,23 +5,53 @@
 #include <vector>
 
 #include "MyVertex.h"
+#include "VertexLayout.h"
 
 /*-----------------------------------------------------------------------------------------------
 Description:
     Stores all info necessary to draw a chunk of vertices and access the info later if
     neccessary.
+
+    Note: The vertices aren't uploaded on their own.  Every object goes into the one shared
+    vertex buffer (see SharedGeometryBuffer), and this only keeps where its piece of that
+    buffer is.
 Creator:    John Cox (10-23-2016)
 -----------------------------------------------------------------------------------------------*/
 struct GeometryData
 {
     GeometryData();
-    void Init(unsigned int programId);
 
-    // save on the large header inclusion of OpenGL and write out these primitive types instead 
+    // save on the large header inclusion of OpenGL and write out these primitive types instead
     // of using the OpenGL typedefs
-    // Note: IDs are GLuint (unsigned int), draw style is GLenum (unsigned int).
-    unsigned int _vaoId;
-    unsigned int _arrayBufferId;
+    // Note: Draw style is GLenum (unsigned int).
     unsigned int _drawStyle;  // GL_TRIANGLES, GL_LINES, etc.
     std::vector<MyVertex> _verts;
-};
\ No newline at end of file
+
+    // empty unless the vertices were welded (see VertexWeld.h), in which case draw with
+    // glDrawElementsBaseVertex(...) instead of glDrawArrays(...)
+    // Note: The indices are always 32-bit here, but they are narrowed to 16-bit on upload if
+    // _indexType is GL_UNSIGNED_SHORT (GLenum).
+    std::vector<unsigned int> _indices;
+    unsigned int _indexType;
+
+    // set on upload (see SharedGeometryBuffer::Add(...))
+    // Note: _baseVertex is where the object's vertices start in the shared vertex buffer and
+    // _firstIndex is where its indices start in the shared element buffer, counted in
+    // _indexType-sized steps.  _drawCount is the number of indices if there are any, otherwise
+    // the number of vertices.
+    unsigned int _baseVertex;
+    unsigned int _firstIndex;
+    unsigned int _drawCount;
+
+    // also set on upload; goes into the shader's "positionDequantization" input when drawing
+    // (see SceneDrawList)
+    PositionQuantization _positionDequantization;
+
+    // set if this object is a translated copy of an earlier one (see TranslatedCopies.h), in
+    // which case _verts and _indices are empty and the earlier one's are drawn again, moved by
+    // _instanceOffset
+    // Note: _instanceOf is a GeometryRegistry::HANDLE in the same scene, or
+    // GeometryRegistry::NO_HANDLE for an object that draws its own vertices.
+    size_t _instanceOf;
+    glm::vec2 _instanceOffset;
+};
@@ -0,0 +1,205 @@
+#include "GeometryRegistry.h"
+
+#include <utility>
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Ensures that the registry starts out empty.
+Parameters: None
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+GeometryRegistry::GeometryRegistry()
+{
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Takes the other registry's objects.  The other registry is left empty.
+Parameters:
+    other   Self-explanatory.
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+GeometryRegistry::GeometryRegistry(GeometryRegistry &&other)
+{
+    Swap(other);
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Throws out this registry's objects and takes the other registry's.  The other registry is
+    left empty.
+Parameters:
+    other   Self-explanatory.
+Returns:
+    A reference to this registry.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+GeometryRegistry &GeometryRegistry::operator=(GeometryRegistry &&other)
+{
+    if (this != &other)
+    {
+        Clear();
+        Swap(other);
+    }
+    return *this;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Finds the object with the given name, or adds an empty one on the end if there isn't one.
+    The caller fills the object in place through Geometry(...) (or moves a finished one into
+    it).
+Parameters:
+    name        Self-explanatory.
+    wasAdded    Optional.  Set to true if the object is new, or false if it was already there.
+Returns:
+    The object's handle.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+GeometryRegistry::HANDLE GeometryRegistry::Add(const std::string &name, bool *wasAdded)
+{
+    auto insertResult = _handlesByName.insert(std::make_pair(name, _geometry.size()));
+    if (wasAdded != 0)
+    {
+        *wasAdded = insertResult.second;
+    }
+
+    if (insertResult.second)
+    {
+        _names.push_back(&insertResult.first->first);
+        _geometry.push_back(GeometryData());
+    }
+    return insertResult.first->second;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Looks up an object by name.
+Parameters:
+    name    Self-explanatory.
+Returns:
+    The object's handle, or NO_HANDLE if there is no object with that name.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+GeometryRegistry::HANDLE GeometryRegistry::Find(const std::string &name) const
+{
+    auto itr = _handlesByName.find(name);
+    return (itr == _handlesByName.end()) ? NO_HANDLE : itr->second;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Self-explanatory.
+Parameters:
+    name    Self-explanatory.
+Returns:
+    True if there is an object with that name, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool GeometryRegistry::Contains(const std::string &name) const
+{
+    return _handlesByName.find(name) != _handlesByName.end();
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Self-explanatory.  The handles are 0 through Size() - 1, in the order that the objects were
+    added.
+Parameters: None
+Returns:
+    The number of objects.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+size_t GeometryRegistry::Size() const
+{
+    return _geometry.size();
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Self-explanatory.
+Parameters:
+    handle  From Add(...), Find(...), or 0 through Size() - 1.
+Returns:
+    A reference to the object's (interned) name.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+const std::string &GeometryRegistry::Name(HANDLE handle) const
+{
+    return *_names[handle];
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Self-explanatory.
+Parameters:
+    handle  From Add(...), Find(...), or 0 through Size() - 1.
+Returns:
+    A reference to the object.  It is only good until the next Add(...).
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+GeometryData &GeometryRegistry::Geometry(HANDLE handle)
+{
+    return _geometry[handle];
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Self-explanatory.
+Parameters:
+    handle  From Add(...), Find(...), or 0 through Size() - 1.
+Returns:
+    A const reference to the object.  It is only good until the next Add(...).
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+const GeometryData &GeometryRegistry::Geometry(HANDLE handle) const
+{
+    return _geometry[handle];
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Makes room for the given number of objects so that adding them doesn't move the array
+    around (or rehash the names) along the way.
+Parameters:
+    numObjects  The total, not the number to be added.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+void GeometryRegistry::Reserve(size_t numObjects)
+{
+    _handlesByName.reserve(numObjects);
+    _names.reserve(numObjects);
+    _geometry.reserve(numObjects);
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Throws out every object and gives the memory back.
+Parameters: None
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+void GeometryRegistry::Clear()
+{
+    GeometryRegistry empty;
+    Swap(empty);
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Trades objects with another registry.  Nothing is copied.
+
+    Note: Swapping an unordered_map keeps its nodes where they are, so the name pointers go
+    along with it.
+Parameters:
+    other   Self-explanatory.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+void GeometryRegistry::Swap(GeometryRegistry &other)
+{
+    _handlesByName.swap(other._handlesByName);
+    _names.swap(other._names);
+    _geometry.swap(other._geometry);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "GeometryData.h"
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    A flat collection of GeometryData objects, each with a name.  The objects sit next to each
+    other in one array in the order that they were added, so drawing all of them every frame is
+    a walk over contiguous memory rather than a hop from one tree node to the next.
+
+    Each name is stored once (interned) in a hash table, and an object is referred to by its
+    handle, which is just its position in the array.  Looking up a name is a single hash.
+
+    Note: Objects are only ever added, never removed one at a time, so a handle stays good
+    until Clear().  References to the GeometryData do not; the array moves when it grows.  Keep
+    the handle instead.
+-----------------------------------------------------------------------------------------------*/
+class GeometryRegistry
+{
+public:
+    typedef size_t HANDLE;
+    static const HANDLE NO_HANDLE = static_cast<size_t>(-1);
+
+    GeometryRegistry();
+    GeometryRegistry(GeometryRegistry &&other);
+    GeometryRegistry &operator=(GeometryRegistry &&other);
+
+    HANDLE Add(const std::string &name, bool *wasAdded = 0);
+    HANDLE Find(const std::string &name) const;
+    bool Contains(const std::string &name) const;
+
+    size_t Size() const;
+    const std::string &Name(HANDLE handle) const;
+    GeometryData &Geometry(HANDLE handle);
+    const GeometryData &Geometry(HANDLE handle) const;
+
+    void Reserve(size_t numObjects);
+    void Clear();
+    void Swap(GeometryRegistry &other);
+
+private:
+    // the names point into _handlesByName, so a copy would point into the wrong table
+    GeometryRegistry(const GeometryRegistry &) = delete;
+    GeometryRegistry &operator=(const GeometryRegistry &) = delete;
+
+    // Note: The nodes of an unordered_map never move, not even when it rehashes, so the
+    // pointers in _names stay good.
+    std::unordered_map<std::string, HANDLE> _handlesByName;
+    std::vector<const std::string *> _names;
+    std::vector<GeometryData> _geometry;
+};
@@ -0,0 +1,157 @@
+#include "LineStitch.h"
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Walks from a vertex along segments that haven't been used yet until it runs out, and
+    writes the vertices that it passes through.
+Parameters:
+    startVert           Self-explanatory.
+    segments            The GL_LINES indices (2 per segment).
+    segmentsByVert      The segments that touch each vertex (see StitchLineStrips(...)).
+    firstSegmentOfVert  Where each vertex's segments start in segmentsByVert.  One extra on
+                        the end.
+    nextSegmentOfVert   How far each vertex's segments have been looked through.  Updated.
+    segmentWasUsed      Updated.
+    putStripHere        Gets startVert, then one vertex per segment walked.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static void WalkStrip(unsigned int startVert, const std::vector<unsigned int> &segments,
+    const std::vector<unsigned int> &segmentsByVert,
+    const std::vector<unsigned int> &firstSegmentOfVert,
+    std::vector<unsigned int> *nextSegmentOfVert, std::vector<bool> *segmentWasUsed,
+    std::vector<unsigned int> *putStripHere)
+{
+    putStripHere->push_back(startVert);
+    unsigned int currentVert = startVert;
+    while (true)
+    {
+        // used segments are never looked at again, so the whole walk is linear
+        unsigned int &nextSegment = (*nextSegmentOfVert)[currentVert];
+        unsigned int lastSegment = firstSegmentOfVert[currentVert + 1];
+        while (nextSegment < lastSegment && (*segmentWasUsed)[segmentsByVert[nextSegment]])
+        {
+            nextSegment++;
+        }
+        if (nextSegment == lastSegment)
+        {
+            return;
+        }
+
+        unsigned int segmentIndex = segmentsByVert[nextSegment];
+        (*segmentWasUsed)[segmentIndex] = true;
+        unsigned int firstEnd = segments[segmentIndex * 2];
+        unsigned int secondEnd = segments[(segmentIndex * 2) + 1];
+        currentVert = (firstEnd == currentVert) ? secondEnd : firstEnd;
+        putStripHere->push_back(currentVert);
+    }
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Stitches segments into strips.  See the header.
+
+    Note: Strips are started from vertices with an odd number of segments first.  Those are
+    where open polylines begin and end, and starting anywhere else would cut an open polyline
+    in two.  Whatever is left after that is made of closed loops, which can start anywhere.
+
+    Also Note: Vertices are visited in order, so the result doesn't depend on anything but the
+    input.
+Parameters:
+    numVerts    Every index is less than this.
+    indices     In: GL_LINES indices (2 per segment).  Out: GL_LINE_STRIP indices, with
+                LINE_STRIP_RESTART_INDEX between strips.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+void StitchLineStrips(size_t numVerts, std::vector<unsigned int> *indices)
+{
+    const std::vector<unsigned int> &segments = *indices;
+    size_t numSegments = segments.size() / 2;
+
+    // the segments that touch each vertex, all in one array (a segment whose ends are the same
+    // vertex is listed twice)
+    std::vector<unsigned int> firstSegmentOfVert(numVerts + 1, 0);
+    for (size_t endIndex = 0; endIndex < numSegments * 2; endIndex++)
+    {
+        firstSegmentOfVert[segments[endIndex] + 1]++;
+    }
+    for (size_t vertIndex = 0; vertIndex < numVerts; vertIndex++)
+    {
+        firstSegmentOfVert[vertIndex + 1] += firstSegmentOfVert[vertIndex];
+    }
+    std::vector<unsigned int> nextSegmentOfVert(firstSegmentOfVert.begin(),
+        firstSegmentOfVert.end() - 1);
+    std::vector<unsigned int> segmentsByVert(numSegments * 2);
+    for (size_t endIndex = 0; endIndex < numSegments * 2; endIndex++)
+    {
+        unsigned int &slot = nextSegmentOfVert[segments[endIndex]];
+        segmentsByVert[slot] = static_cast<unsigned int>(endIndex / 2);
+        slot++;
+    }
+    nextSegmentOfVert.assign(firstSegmentOfVert.begin(), firstSegmentOfVert.end() - 1);
+
+    // at worst (no shared endpoints) this is the same size as the input plus the restarts
+    std::vector<bool> segmentWasUsed(numSegments, false);
+    std::vector<unsigned int> strips;
+    strips.reserve(numSegments * 3);
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (unsigned int vertIndex = 0; vertIndex < numVerts; vertIndex++)
+        {
+            unsigned int numVertSegments =
+                firstSegmentOfVert[vertIndex + 1] - firstSegmentOfVert[vertIndex];
+            bool isOddVert = (numVertSegments % 2) == 1;
+            if (pass == 0 && !isOddVert)
+            {
+                continue;
+            }
+
+            // a vertex may have more than one strip going through it
+            while (nextSegmentOfVert[vertIndex] < firstSegmentOfVert[vertIndex + 1])
+            {
+                size_t stripBegin = strips.size();
+                if (stripBegin > 0)
+                {
+                    strips.push_back(LINE_STRIP_RESTART_INDEX);
+                    stripBegin++;
+                }
+                WalkStrip(vertIndex, segments, segmentsByVert, firstSegmentOfVert,
+                    &nextSegmentOfVert, &segmentWasUsed, &strips);
+
+                // nothing was left at this vertex after all, so take back the start
+                if (strips.size() - stripBegin == 1)
+                {
+                    strips.resize((stripBegin > 0) ? stripBegin - 1 : 0);
+                }
+            }
+        }
+    }
+
+    strips.shrink_to_fit();
+    indices->swap(strips);
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Counts the segments in the output of StitchLineStrips(...).
+Parameters:
+    indices     GL_LINE_STRIP indices with LINE_STRIP_RESTART_INDEX between strips.
+Returns:
+    The number of segments that were stitched together (so half the number of GL_LINES
+    indices that it replaced).
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+size_t CountLineStripSegments(const std::vector<unsigned int> &indices)
+{
+    size_t numSegments = 0;
+    for (size_t index = 1; index < indices.size(); index++)
+    {
+        if (indices[index] != LINE_STRIP_RESTART_INDEX &&
+            indices[index - 1] != LINE_STRIP_RESTART_INDEX)
+        {
+            numSegments++;
+        }
+    }
+    return numSegments;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+// separates one strip from the next in the output of StitchLineStrips(...)
+// Note: This is the index that GL_PRIMITIVE_RESTART_FIXED_INDEX restarts on for 32-bit
+// indices, and it narrows to 0xFFFF, the one for 16-bit indices.  Welding never hands out
+// either (see the index type in BlenderLoad.cpp).
+const unsigned int LINE_STRIP_RESTART_INDEX = 0xFFFFFFFF;
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Chains line segments that share endpoints into strips.  Drawing the result as
+    GL_LINE_STRIP with primitive restart gives the same picture as drawing the original
+    segments as GL_LINES, but every point along a strip is only referred to once instead of
+    twice.
+
+    Note: This works on indices, so the segments have to be welded first (see VertexWeld.h);
+    that is how it knows which endpoints are shared.  A closed outline (a circle) comes out as
+    a single strip that ends on the index it started with.
+-----------------------------------------------------------------------------------------------*/
+
+void StitchLineStrips(size_t numVerts, std::vector<unsigned int> *indices);
+size_t CountLineStripSegments(const std::vector<unsigned int> &indices);
@@ -0,0 +1,192 @@
+#include "MemoryMappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Ensures that the object starts with initialized values.  Nothing is mapped until Open(...)
+    is called.
+Parameters: None
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+MemoryMappedFile::MemoryMappedFile() :
+    _data(0),
+    _size(0),
+#ifdef _WIN32
+    _fileHandle(INVALID_HANDLE_VALUE),
+    _mappingHandle(0)
+#else
+    _fileDescriptor(-1)
+#endif
+{
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Unmaps the view (if any) and releases the OS handles.
+Parameters: None
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+MemoryMappedFile::~MemoryMappedFile()
+{
+    Close();
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Opens the file for reading and maps the whole thing into memory.  Any previously mapped
+    file is closed first.
+
+    Note: An empty file is a valid file, but it cannot be mapped (both Windows and POSIX refuse
+    zero-length mappings), so it is reported as opened with a null data pointer and size 0.
+Parameters:
+    filePath    Self-explanatory.
+Returns:
+    True if the file was mapped (or is empty), otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool MemoryMappedFile::Open(const std::string &filePath)
+{
+    Close();
+
+#ifdef _WIN32
+    // the project uses the Unicode character set, so explicitly ask for the narrow version
+    _fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, 0,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, 0);
+    if (_fileHandle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(_fileHandle, &fileSize))
+    {
+        Close();
+        return false;
+    }
+
+    _size = static_cast<size_t>(fileSize.QuadPart);
+    if (_size == 0)
+    {
+        return true;
+    }
+
+    _mappingHandle = CreateFileMappingA(_fileHandle, 0, PAGE_READONLY, 0, 0, 0);
+    if (_mappingHandle == 0)
+    {
+        Close();
+        return false;
+    }
+
+    _data = static_cast<const char *>(MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (_data == 0)
+    {
+        Close();
+        return false;
+    }
+#else
+    _fileDescriptor = open(filePath.c_str(), O_RDONLY);
+    if (_fileDescriptor < 0)
+    {
+        return false;
+    }
+
+    struct stat fileInfo;
+    if (fstat(_fileDescriptor, &fileInfo) != 0)
+    {
+        Close();
+        return false;
+    }
+
+    _size = static_cast<size_t>(fileInfo.st_size);
+    if (_size == 0)
+    {
+        return true;
+    }
+
+    void *mapped = mmap(0, _size, PROT_READ, MAP_PRIVATE, _fileDescriptor, 0);
+    if (mapped == MAP_FAILED)
+    {
+        Close();
+        return false;
+    }
+
+    // the loader reads front to back, so let the kernel read ahead aggressively
+    madvise(mapped, _size, MADV_SEQUENTIAL);
+    _data = static_cast<const char *>(mapped);
+#endif
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Unmaps the view and closes the file.  Safe to call multiple times.
+Parameters: None
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+void MemoryMappedFile::Close()
+{
+#ifdef _WIN32
+    if (_data != 0)
+    {
+        UnmapViewOfFile(_data);
+    }
+    if (_mappingHandle != 0)
+    {
+        CloseHandle(_mappingHandle);
+        _mappingHandle = 0;
+    }
+    if (_fileHandle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(_fileHandle);
+        _fileHandle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (_data != 0)
+    {
+        munmap(const_cast<char *>(_data), _size);
+    }
+    if (_fileDescriptor >= 0)
+    {
+        close(_fileDescriptor);
+        _fileDescriptor = -1;
+    }
+#endif
+
+    _data = 0;
+    _size = 0;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    A getter for the start of the mapped bytes.  Null if nothing is mapped.
+Parameters: None
+Returns:
+    See description.
+-----------------------------------------------------------------------------------------------*/
+const char *MemoryMappedFile::Data() const
+{
+    return _data;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    A getter for the number of mapped bytes.
+Parameters: None
+Returns:
+    See description.
+-----------------------------------------------------------------------------------------------*/
+size_t MemoryMappedFile::Size() const
+{
+    return _size;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    A read-only view of an entire file that has been mapped into the process' address space.
+    The operating system pages the file in as it is touched, so there is no up-front copy into
+    a std::string or a std::stringstream buffer.
+
+    Note: The mapped bytes are NOT null-terminated.  Always use Data() together with Size().
+-----------------------------------------------------------------------------------------------*/
+class MemoryMappedFile
+{
+public:
+    MemoryMappedFile();
+    ~MemoryMappedFile();
+
+    bool Open(const std::string &filePath);
+    void Close();
+
+    const char *Data() const;
+    size_t Size() const;
+
+private:
+    // the destructor unmaps the view, so copies would leave a dangling pointer behind
+    MemoryMappedFile(const MemoryMappedFile &) = delete;
+    MemoryMappedFile &operator=(const MemoryMappedFile &) = delete;
+
+    const char *_data;
+    size_t _size;
+
+    // save on the large header inclusion of the OS headers and write out the handle types
+    // Note: Windows HANDLEs are void *, POSIX file descriptors are int.
+#ifdef _WIN32
+    void *_fileHandle;
+    void *_mappingHandle;
+#else
+    int _fileDescriptor;
+#endif
+};
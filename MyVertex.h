@@ -10,6 +10,21 @@ Creator: John Cox (6-12-2016)
 -----------------------------------------------------------------------------------------------*/
 struct MyVertex
 {
+    /*-------------------------------------------------------------------------------------------
+    Description:
+        Ensures that the object starts with initialized values.  Only needed so that vertex
+        collections can be resized up front and then filled in place (see the multithreaded
+        loader in BlenderLoad.cpp).
+    Parameters: None
+    Returns:    None
+    -------------------------------------------------------------------------------------------*/
+    MyVertex() :
+        _position(0.0f, 0.0f, 0.0f, 1.0f),
+        _normal(0.0f, 0.0f, 0.0f, 0.0f)
+    {
+
+    }
+
     /*-------------------------------------------------------------------------------------------
     Description:
         Ensures that the object starts object with initialized values.
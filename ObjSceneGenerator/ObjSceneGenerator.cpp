@@ -0,0 +1,350 @@
+// Writes synthetic .obj files that look like Blender's exports of circle_square_grid.blend, for
+// measuring the loader.  Not part of the demo itself.
+// Usage: ObjSceneGenerator <output.obj> [options]
+// Run with no arguments to list the options.
+// Ex: The demo loads BlenderStuff/circle_square_grid.obj, which is not checked in.  Make one with
+// "ObjSceneGenerator BlenderStuff/circle_square_grid.obj --objects 16".
+
+// for printf(...), fopen(...), etc.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <math.h>
+#include <vector>
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Everything that can be set from the command line.
+-----------------------------------------------------------------------------------------------*/
+struct SceneSettings
+{
+    SceneSettings() :
+        _numObjects(1000),
+        _targetMegabytes(0.0),
+        _lineFraction(0.5),
+        _circleSegments(32),
+        _gridQuadsPerSide(10)
+    {
+    }
+
+    // ignored if _targetMegabytes is not 0
+    unsigned long long _numObjects;
+
+    // keep writing objects until the file is at least this big
+    double _targetMegabytes;
+
+    // what fraction of objects are circles drawn with lines (the rest are grids of quads)
+    double _lineFraction;
+
+    unsigned int _circleSegments;
+    unsigned int _gridQuadsPerSide;
+};
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    A big output buffer in front of fwrite(...) so that each line doesn't cost a library call
+    with its own locking.
+-----------------------------------------------------------------------------------------------*/
+class ObjWriter
+{
+public:
+    ObjWriter(FILE *file) :
+        _file(file),
+        _numBytesWritten(0)
+    {
+        _buffer.reserve(BUFFER_SIZE + 256);
+    }
+
+    ~ObjWriter()
+    {
+        Flush();
+    }
+
+    // printf(...)-style; every line in an .obj file is way shorter than 256 characters
+    template<typename... ARGS>
+    void Line(const char *format, ARGS... args)
+    {
+        char line[256];
+        int numChars = snprintf(line, sizeof(line), format, args...);
+        _buffer.insert(_buffer.end(), line, line + numChars);
+        _numBytesWritten += numChars;
+        if (_buffer.size() >= BUFFER_SIZE)
+        {
+            Flush();
+        }
+    }
+
+    void Flush()
+    {
+        fwrite(_buffer.data(), 1, _buffer.size(), _file);
+        _buffer.clear();
+    }
+
+    unsigned long long NumBytesWritten() const
+    {
+        return _numBytesWritten;
+    }
+
+private:
+    static const size_t BUFFER_SIZE = 1024 * 1024;
+
+    FILE *_file;
+    std::vector<char> _buffer;
+    unsigned long long _numBytesWritten;
+};
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Writes a circle that is drawn with lines, the way that Blender exports a mesh that only has
+    edges: positions, then one "l" per edge.  There are no normals.
+Parameters:
+    writer          Self-explanatory.
+    objectNumber    For the name ("Circle.001", etc.).
+    centerX         Self-explanatory.
+    centerY         Self-explanatory.
+    radius          Self-explanatory.
+    numSegments     Self-explanatory.
+    nextPosition    In: the 1-based index of the first position in this object.  Out: past the
+                    last one.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static void WriteCircle(ObjWriter *writer, unsigned long long objectNumber, double centerX,
+    double centerY, double radius, unsigned int numSegments, unsigned long long *nextPosition)
+{
+    writer->Line("o Circle.%03llu\n", objectNumber);
+    for (unsigned int segmentIndex = 0; segmentIndex < numSegments; segmentIndex++)
+    {
+        double angle = 2.0 * 3.14159265358979323846 * segmentIndex / numSegments;
+        writer->Line("v %.6f %.6f 0.000000\n", centerX + radius * cos(angle),
+            centerY + radius * sin(angle));
+    }
+
+    unsigned long long first = *nextPosition;
+    for (unsigned int segmentIndex = 0; segmentIndex < numSegments; segmentIndex++)
+    {
+        writer->Line("l %llu %llu\n", first + segmentIndex,
+            first + ((segmentIndex + 1) % numSegments));
+    }
+    *nextPosition += numSegments;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Writes a flat, subdivided plane the way that Blender exports it: positions, a single normal
+    (they all face +Z), the material and smoothing lines, and then one "f" quad per grid cell.
+Parameters:
+    writer          Self-explanatory.
+    objectNumber    For the name ("Plane.001", etc.).
+    centerX         Self-explanatory.
+    centerY         Self-explanatory.
+    halfWidth       Self-explanatory.
+    quadsPerSide    Self-explanatory.
+    nextPosition    In: the 1-based index of the first position in this object.  Out: past the
+                    last one.
+    nextNormal      Same as nextPosition, but for normals.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static void WriteGrid(ObjWriter *writer, unsigned long long objectNumber, double centerX,
+    double centerY, double halfWidth, unsigned int quadsPerSide,
+    unsigned long long *nextPosition, unsigned long long *nextNormal)
+{
+    writer->Line("o Plane.%03llu\n", objectNumber);
+    unsigned int positionsPerSide = quadsPerSide + 1;
+    double step = (2.0 * halfWidth) / quadsPerSide;
+    for (unsigned int row = 0; row < positionsPerSide; row++)
+    {
+        for (unsigned int column = 0; column < positionsPerSide; column++)
+        {
+            writer->Line("v %.6f %.6f 0.000000\n", centerX - halfWidth + column * step,
+                centerY - halfWidth + row * step);
+        }
+    }
+    writer->Line("vn 0.0000 0.0000 1.0000\n");
+    writer->Line("usemtl None\n");
+    writer->Line("s off\n");
+
+    // counterclockwise, seen from +Z
+    unsigned long long first = *nextPosition;
+    unsigned long long normal = *nextNormal;
+    for (unsigned int row = 0; row < quadsPerSide; row++)
+    {
+        for (unsigned int column = 0; column < quadsPerSide; column++)
+        {
+            unsigned long long corner = first + row * positionsPerSide + column;
+            writer->Line("f %llu//%llu %llu//%llu %llu//%llu %llu//%llu\n",
+                corner, normal, corner + 1, normal, corner + positionsPerSide + 1, normal,
+                corner + positionsPerSide, normal);
+        }
+    }
+    *nextPosition += positionsPerSide * positionsPerSide;
+    *nextNormal += 1;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Writes the whole file.  Objects are laid out on a square grid over window space ([-1,+1] on
+    X and Y) so that the demo can draw any of the generated files.  Circles and grids are mixed
+    evenly throughout the file according to the line fraction.
+Parameters:
+    file            Self-explanatory.
+    settings        Self-explanatory.
+    numBytesOut     Gets the size of the file.
+Returns:
+    The number of objects that were written.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static unsigned long long WriteScene(FILE *file, const SceneSettings &settings,
+    unsigned long long *numBytesOut)
+{
+    ObjWriter writer(file);
+    writer.Line("# Blender v2.78 (sub 0) OBJ File: 'circle_square_grid.blend'\n");
+    writer.Line("# www.blender.org\n");
+    writer.Line("mtllib circle_square_grid.mtl\n");
+
+    // if the object count isn't known, guess it from the size of an average object so that
+    // the layout still comes out roughly square
+    unsigned long long layoutCount = settings._numObjects;
+    if (settings._targetMegabytes > 0.0)
+    {
+        double bytesPerCircle = settings._circleSegments * 40.0;
+        double bytesPerGrid = (settings._gridQuadsPerSide + 1.0) *
+            (settings._gridQuadsPerSide + 1.0) * 30.0 +
+            settings._gridQuadsPerSide * settings._gridQuadsPerSide * 40.0;
+        double bytesPerObject = settings._lineFraction * bytesPerCircle +
+            (1.0 - settings._lineFraction) * bytesPerGrid;
+        layoutCount = static_cast<unsigned long long>(
+            (settings._targetMegabytes * 1024.0 * 1024.0) / bytesPerObject) + 1;
+    }
+    unsigned long long objectsPerSide =
+        static_cast<unsigned long long>(ceil(sqrt(static_cast<double>(layoutCount))));
+    double cellSize = 2.0 / objectsPerSide;
+
+    unsigned long long targetBytes =
+        static_cast<unsigned long long>(settings._targetMegabytes * 1024.0 * 1024.0);
+    unsigned long long nextPosition = 1;
+    unsigned long long nextNormal = 1;
+    unsigned long long objectIndex = 0;
+    while (true)
+    {
+        if (settings._targetMegabytes > 0.0)
+        {
+            if (writer.NumBytesWritten() >= targetBytes)
+            {
+                break;
+            }
+        }
+        else if (objectIndex >= settings._numObjects)
+        {
+            break;
+        }
+
+        // wraps around (and overlaps) if the size guess was low
+        unsigned long long cellIndex = objectIndex % (objectsPerSide * objectsPerSide);
+        double centerX = -1.0 + cellSize * ((cellIndex % objectsPerSide) + 0.5);
+        double centerY = -1.0 + cellSize * ((cellIndex / objectsPerSide) + 0.5);
+        double halfWidth = cellSize * 0.4;
+
+        // spread the circles evenly instead of putting them all at the start
+        bool isCircle = floor((objectIndex + 1) * settings._lineFraction) >
+            floor(objectIndex * settings._lineFraction);
+        if (isCircle)
+        {
+            WriteCircle(&writer, objectIndex, centerX, centerY, halfWidth,
+                settings._circleSegments, &nextPosition);
+        }
+        else
+        {
+            WriteGrid(&writer, objectIndex, centerX, centerY, halfWidth,
+                settings._gridQuadsPerSide, &nextPosition, &nextNormal);
+        }
+        objectIndex++;
+    }
+
+    writer.Flush();
+    *numBytesOut = writer.NumBytesWritten();
+    return objectIndex;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Reads the settings from the command line and writes the file.
+Parameters:
+    argc    The number of strings in argv.
+    argv    [1] is the output path, and the rest are "--option value" pairs.
+Returns:
+    0 if the file was written, otherwise 1.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+int main(int argc, char *argv[])
+{
+    SceneSettings settings;
+    bool argumentsOk = (argc >= 2) && ((argc % 2) == 0);
+    for (int argIndex = 2; argumentsOk && argIndex + 1 < argc; argIndex += 2)
+    {
+        const char *option = argv[argIndex];
+        const char *value = argv[argIndex + 1];
+        if (strcmp(option, "--objects") == 0)
+        {
+            settings._numObjects = strtoull(value, 0, 10);
+        }
+        else if (strcmp(option, "--megabytes") == 0)
+        {
+            settings._targetMegabytes = atof(value);
+        }
+        else if (strcmp(option, "--line-fraction") == 0)
+        {
+            settings._lineFraction = atof(value);
+        }
+        else if (strcmp(option, "--circle-segments") == 0)
+        {
+            settings._circleSegments = strtoul(value, 0, 10);
+        }
+        else if (strcmp(option, "--grid") == 0)
+        {
+            settings._gridQuadsPerSide = strtoul(value, 0, 10);
+        }
+        else
+        {
+            argumentsOk = false;
+        }
+    }
+
+    if (!argumentsOk || settings._circleSegments < 3 || settings._gridQuadsPerSide < 1 ||
+        settings._lineFraction < 0.0 || settings._lineFraction > 1.0)
+    {
+        printf("usage: %s <output.obj> [options]\n", argv[0]);
+        printf("    --objects N           how many objects to write (default 1000)\n");
+        printf("    --megabytes M         write objects until the file is M MB "
+            "(overrides --objects)\n");
+        printf("    --line-fraction F     fraction of objects that are line circles "
+            "(default 0.5)\n");
+        printf("    --circle-segments S   positions/lines per circle, at least 3 (default 32)\n");
+        printf("    --grid G              quads per side of each plane, at least 1 (default 10)\n");
+        return 1;
+    }
+
+    FILE *file = fopen(argv[1], "wb");
+    if (file == 0)
+    {
+        printf("could not open '%s' for writing\n", argv[1]);
+        return 1;
+    }
+
+    // Note: Not ftell(...), which is 32-bit on Windows and these files can be gigabytes.
+    unsigned long long numBytes = 0;
+    unsigned long long numObjects = WriteScene(file, settings, &numBytes);
+    bool writeFailed = (ferror(file) != 0);
+    fclose(file);
+    if (writeFailed)
+    {
+        printf("could not write '%s'\n", argv[1]);
+        return 1;
+    }
+
+    printf("wrote %llu objects (%.2f MB) to '%s'\n", numObjects,
+        numBytes / (1024.0 * 1024.0), argv[1]);
+    return 0;
+}
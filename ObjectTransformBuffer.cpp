@@ -0,0 +1,235 @@
+#include "ObjectTransformBuffer.h"
+
+#include <math.h>
+#include <string.h>
+#include "glload/include/glload/gl_4_4.h"
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+// "layout (std430, binding = 0) buffer ObjectTransforms" in the vertex shader
+static const unsigned int OBJECT_TRANSFORMS_BUFFER_BINDING = 0;
+
+// the GPU can be a frame or two behind, and the ring needs one more region than that so the
+// CPU doesn't wait on it
+static const unsigned int NUM_TRANSFORM_REGIONS = 3;
+
+// room for this many objects before the ring has to be resized
+static const size_t INITIAL_TRANSFORM_CAPACITY = 4096;
+
+static_assert(sizeof(ObjectTransform2D) == 8 * sizeof(float),
+    "ObjectTransform2D doesn't match the shader's std430 struct");
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    The identity transform.  The object stays where its vertices put it.
+Parameters: None
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+ObjectTransform2D::ObjectTransform2D() :
+    _linear(1.0f, 0.0f, 0.0f, 1.0f),
+    _translation(0.0f, 0.0f),
+    _padding(0.0f, 0.0f)
+{
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Scales and then rotates the object about a point, and then moves it.
+Parameters:
+    translation     How far to move the object, in window space.
+    rotationRadians Counterclockwise.
+    scale           X and Y scale.
+    center          The point (in window space, like the object's vertices) that scaling and
+                    rotation happen around.  Usually the object's center.
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+ObjectTransform2D::ObjectTransform2D(const glm::vec2 &translation, float rotationRadians,
+    const glm::vec2 &scale, const glm::vec2 &center) :
+    _padding(0.0f, 0.0f)
+{
+    float cosAngle = cosf(rotationRadians);
+    float sinAngle = sinf(rotationRadians);
+    glm::vec2 xColumn(cosAngle * scale.x, sinAngle * scale.x);
+    glm::vec2 yColumn(-sinAngle * scale.y, cosAngle * scale.y);
+    _linear = glm::vec4(xColumn, yColumn);
+
+    // (linear * (position - center)) + center + translation, folded into one translation
+    _translation = center + translation - ((xColumn * center.x) + (yColumn * center.y));
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Ensures that the object starts with initialized values.  Nothing is uploaded until Init()
+    is called.
+Parameters: None
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+ObjectTransformBuffer::ObjectTransformBuffer() :
+    _dirty(false)
+{
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Creates the ring buffer.  Each Upload() binds the region that it wrote to the shader's
+    binding point.
+Parameters: None
+Returns:
+    False if the vertex shader can't read shader storage buffers or the ring couldn't be
+    mapped, otherwise true.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool ObjectTransformBuffer::Init()
+{
+    GLint maxVertexStorageBlocks = 0;
+    glGetIntegerv(GL_MAX_VERTEX_SHADER_STORAGE_BLOCKS, &maxVertexStorageBlocks);
+    if (maxVertexStorageBlocks < 1)
+    {
+        cout << "ObjectTransformBuffer: the vertex shader can't read shader storage buffers"
+            << endl;
+        return false;
+    }
+
+    GLint offsetAlignment = 1;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+    return _ring.Init(INITIAL_TRANSFORM_CAPACITY * sizeof(ObjectTransform2D),
+        NUM_TRANSFORM_REGIONS, static_cast<size_t>(offsetAlignment));
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Makes room for a transform for every object in the scene.  New objects get the identity
+    transform.  Call whenever objects are added.
+Parameters:
+    numObjects  GeometryRegistry::Size().
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+void ObjectTransformBuffer::Resize(size_t numObjects)
+{
+    if (numObjects != _transforms.size())
+    {
+        _transforms.resize(numObjects);
+        _dirty = true;
+    }
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Self-explanatory.
+Parameters: None
+Returns:
+    The number of objects that have a transform.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+size_t ObjectTransformBuffer::Size() const
+{
+    return _transforms.size();
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Self-explanatory.
+Parameters:
+    handle  0 through Size() - 1.
+Returns:
+    A const reference to the object's transform as of the last SetTransform(...).
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+const ObjectTransform2D &ObjectTransformBuffer::Transform(GeometryRegistry::HANDLE handle) const
+{
+    return _transforms[handle];
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Changes an object's transform.  The change shows up after the next Upload().
+
+    Note: An object's translated copies (see TranslatedCopies.h) have their own handles and
+    their own transforms.
+Parameters:
+    handle      0 through Size() - 1.
+    transform   Self-explanatory.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+void ObjectTransformBuffer::SetTransform(GeometryRegistry::HANDLE handle,
+    const ObjectTransform2D &transform)
+{
+    _transforms[handle] = transform;
+    _dirty = true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Call once per frame, before drawing.  If any transform changed, writes all of them into
+    the ring's next region in one go and binds that region for the shader.  Otherwise does
+    nothing, and the last region stays bound.
+
+    Note: If there are more objects than a region holds, the ring is resized to twice what is
+    needed.  That waits for the GPU, but only happens a few times while the scene loads.
+
+    Also Note: If the write fails, the shader's binding can't be trusted (it may be the old
+    buffer that the resize threw out, or too small for the new objects), so nothing that reads
+    the transforms may be drawn this frame.  The changes are kept and tried again next frame.
+Parameters: None
+Returns:
+    True if every object's transform is bound for the shader, otherwise false (don't draw).
+-----------------------------------------------------------------------------------------------*/
+bool ObjectTransformBuffer::Upload()
+{
+    // never made (Init() failed) or thrown out by a resize that failed
+    if (_ring.BufferId() == 0)
+    {
+        return false;
+    }
+    if (!_dirty || _transforms.empty())
+    {
+        return true;
+    }
+
+    size_t numBytes = _transforms.size() * sizeof(ObjectTransform2D);
+    if (numBytes > _ring.RegionBytes() && !_ring.Resize(numBytes * 2))
+    {
+        return false;
+    }
+    void *region = _ring.BeginRegion();
+    if (region == 0)
+    {
+        return false;
+    }
+
+    memcpy(region, _transforms.data(), numBytes);
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, OBJECT_TRANSFORMS_BUFFER_BINDING,
+        _ring.BufferId(), _ring.RegionOffset(), numBytes);
+    _dirty = false;
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Call once per frame, after drawing.  Fences the region that the shader read from this
+    frame (whether or not Upload() wrote it this frame), so that it isn't written again while
+    the GPU is still reading it.
+Parameters: None
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+void ObjectTransformBuffer::EndFrame()
+{
+    _ring.EndRegion();
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Self-explanatory.
+Parameters: None
+Returns:
+    A const reference to the ring buffer, for its fence wait counters.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+const PersistentRingBuffer &ObjectTransformBuffer::Ring() const
+{
+    return _ring;
+}
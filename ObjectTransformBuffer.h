@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+#include "glm/vec2.hpp"
+#include "glm/vec4.hpp"
+
+#include "GeometryRegistry.h"
+#include "PersistentRingBuffer.h"
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Moves, rotates, and scales one object in window space.  The vertex shader reads these from
+    its "ObjectTransforms" shader storage buffer and computes
+    (linear * position) + translation, where linear is a column-major 2x2 matrix.
+
+    Note: The layout matches the shader's std430 struct (a vec4 and a vec2, padded to 16 bytes),
+    so it must not be changed on only one side.
+-----------------------------------------------------------------------------------------------*/
+struct ObjectTransform2D
+{
+    ObjectTransform2D();
+    ObjectTransform2D(const glm::vec2 &translation, float rotationRadians,
+        const glm::vec2 &scale, const glm::vec2 &center);
+
+    // xy: the first column, zw: the second column
+    glm::vec4 _linear;
+    glm::vec2 _translation;
+    glm::vec2 _padding;
+};
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    One ObjectTransform2D per object in the scene, indexed by the object's handle
+    (GeometryRegistry::HANDLE), in a shader storage buffer.  Every object in a multi-draw
+    (see SceneDrawList) can then be moved on its own, and moving thousands of them costs one
+    buffer write per frame instead of a uniform upload and a draw call per object.
+
+    Changes are kept on the CPU until Upload(), which writes all of them into the next region
+    of a persistently mapped ring (see PersistentRingBuffer) if anything changed since the last
+    upload.  Nothing is allocated or mapped per frame.
+
+    Note: The vertex shader must be able to read shader storage buffers.  GL 4.3 doesn't
+    require that, so Init() checks for it.
+
+    Also Note: Only the thread that owns the OpenGL context may use this.
+-----------------------------------------------------------------------------------------------*/
+class ObjectTransformBuffer
+{
+public:
+    ObjectTransformBuffer();
+
+    bool Init();
+    void Resize(size_t numObjects);
+    size_t Size() const;
+    const ObjectTransform2D &Transform(GeometryRegistry::HANDLE handle) const;
+    void SetTransform(GeometryRegistry::HANDLE handle, const ObjectTransform2D &transform);
+    bool Upload();
+    void EndFrame();
+    const PersistentRingBuffer &Ring() const;
+
+private:
+    ObjectTransformBuffer(const ObjectTransformBuffer &) = delete;
+    ObjectTransformBuffer &operator=(const ObjectTransformBuffer &) = delete;
+
+    // one region per frame in flight
+    PersistentRingBuffer _ring;
+
+    std::vector<ObjectTransform2D> _transforms;
+
+    // true if _transforms has changed since the last Upload()
+    bool _dirty;
+};
@@ -0,0 +1,314 @@
+#include "PersistentRingBuffer.h"
+
+#include <chrono>
+#include "glload/include/glload/gl_4_4.h"
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+// write-only from the CPU, and never unmapped
+static const GLbitfield RING_BUFFER_FLAGS =
+    GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+// how long a single glClientWaitSync(...) may block before it is tried again
+// Note: 1 second.  A region is normally free long before this.
+static const GLuint64 FENCE_TIMEOUT_NANOSECONDS = 1000000000;
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Ensures that the object starts with initialized values.  Nothing is allocated until
+    Init(...) is called.
+Parameters: None
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+PersistentRingBuffer::PersistentRingBuffer() :
+    _bufferId(0),
+    _mappedBytes(0),
+    _alignment(1),
+    _regionBytes(0),
+    _numRegions(0),
+    _currentRegion(0),
+    _regionOpen(false),
+    _numRegionsBegun(0),
+    _numFenceWaits(0),
+    _fenceWaitSeconds(0.0)
+{
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Creates and maps the buffer.
+Parameters:
+    bytesPerRegion  The most that will be written in one region.
+    numRegions      How many regions the ring is split into; usually the number of frames the
+                    GPU may be behind, plus one (so 3).
+    alignment       What each region's offset must be a multiple of, such as
+                    GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT for glBindBufferRange(...).
+Returns:
+    False if the buffer couldn't be mapped, otherwise true.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool PersistentRingBuffer::Init(size_t bytesPerRegion, unsigned int numRegions,
+    size_t alignment)
+{
+    _numRegions = (numRegions > 0) ? numRegions : 1;
+    _alignment = (alignment > 0) ? alignment : 1;
+    return Allocate(bytesPerRegion);
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Replaces the buffer with one whose regions have the given size.  Immutable storage can't
+    grow, so this waits for the GPU to finish with every region, and then the old buffer is
+    thrown out.  This stalls, so it is for the occasional size change and not for every frame.
+
+    Note: The contents are not kept, and the buffer ID changes, so anything bound to the old
+    buffer must be bound again.  An open region is closed first.
+Parameters:
+    bytesPerRegion  See Init(...).
+Returns:
+    False if the new buffer couldn't be mapped, otherwise true.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool PersistentRingBuffer::Resize(size_t bytesPerRegion)
+{
+    if (_regionOpen)
+    {
+        EndRegion();
+    }
+    for (unsigned int regionIndex = 0; regionIndex < _fences.size(); regionIndex++)
+    {
+        WaitForRegion(regionIndex);
+    }
+
+    if (_bufferId != 0)
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, _bufferId);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        glDeleteBuffers(1, &_bufferId);
+        _bufferId = 0;
+        _mappedBytes = 0;
+    }
+    return Allocate(bytesPerRegion);
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Moves on to the next region and waits, if it has to, for the GPU to finish reading what
+    was last written there.  Call once per frame, before writing that frame's data.
+Parameters: None
+Returns:
+    Where to write the region's data (RegionBytes() of it), or null if the buffer isn't
+    mapped.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+void *PersistentRingBuffer::BeginRegion()
+{
+    if (_mappedBytes == 0)
+    {
+        return 0;
+    }
+
+    // a region that was never fenced might still be read by draws that were already issued
+    if (_regionOpen)
+    {
+        EndRegion();
+    }
+
+    unsigned int nextRegion = (_currentRegion + 1) % _numRegions;
+    WaitForRegion(nextRegion);
+    _currentRegion = nextRegion;
+    _regionOpen = true;
+    _numRegionsBegun++;
+    return _mappedBytes + RegionOffset();
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Puts a fence after the commands that read the current region, so that BeginRegion() knows
+    when the region can be written again.  Call after the frame's draws.
+
+    Note: Call it after every frame that reads the region, not just the one that wrote it.  A
+    region that is drawn from for several frames must not be written again until the last of
+    them is done, so its fence is replaced each time.
+Parameters: None
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+void PersistentRingBuffer::EndRegion()
+{
+    if (_numRegionsBegun == 0 || _mappedBytes == 0)
+    {
+        return;
+    }
+
+    GLsync oldFence = static_cast<GLsync>(_fences[_currentRegion]);
+    if (oldFence != 0)
+    {
+        glDeleteSync(oldFence);
+    }
+    _fences[_currentRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    _regionOpen = false;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Self-explanatory.
+Parameters: None
+Returns:
+    The buffer's OpenGL ID.  Changes if the buffer is resized.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+unsigned int PersistentRingBuffer::BufferId() const
+{
+    return _bufferId;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Self-explanatory.
+Parameters: None
+Returns:
+    Where the region from the last BeginRegion() starts in the buffer, in bytes.  For
+    glBindBufferRange(...), vertex buffer offsets, and the like.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+size_t PersistentRingBuffer::RegionOffset() const
+{
+    return _currentRegion * _regionBytes;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Self-explanatory.
+Parameters: None
+Returns:
+    The size of each region, in bytes.  This is at least what Init(...) or Resize(...) asked
+    for.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+size_t PersistentRingBuffer::RegionBytes() const
+{
+    return _regionBytes;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Self-explanatory.
+Parameters: None
+Returns:
+    How many times BeginRegion() has handed out a region.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+unsigned long long PersistentRingBuffer::NumRegionsBegun() const
+{
+    return _numRegionsBegun;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Self-explanatory.
+Parameters: None
+Returns:
+    How many times a region's fence hadn't been signaled yet and the CPU had to block.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+unsigned long long PersistentRingBuffer::NumFenceWaits() const
+{
+    return _numFenceWaits;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Self-explanatory.
+Parameters: None
+Returns:
+    The total time that the CPU has spent blocked on fences.  If this grows, the GPU is more
+    frames behind than there are regions.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+double PersistentRingBuffer::FenceWaitSeconds() const
+{
+    return _fenceWaitSeconds;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Creates the buffer with immutable storage and maps all of it.  The first BeginRegion()
+    then returns region 0.
+Parameters:
+    bytesPerRegion  See Init(...).
+Returns:
+    False if the buffer couldn't be mapped, otherwise true.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool PersistentRingBuffer::Allocate(size_t bytesPerRegion)
+{
+    size_t numAlignments = (bytesPerRegion + _alignment - 1) / _alignment;
+    _regionBytes = ((numAlignments > 0) ? numAlignments : 1) * _alignment;
+    _fences.assign(_numRegions, 0);
+    _currentRegion = _numRegions - 1;
+    _regionOpen = false;
+
+    GLsizeiptr totalBytes = static_cast<GLsizeiptr>(_regionBytes * _numRegions);
+    glGenBuffers(1, &_bufferId);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _bufferId);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, totalBytes, 0, RING_BUFFER_FLAGS);
+    _mappedBytes = static_cast<char *>(
+        glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, totalBytes, RING_BUFFER_FLAGS));
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    if (_mappedBytes == 0)
+    {
+        cout << "PersistentRingBuffer: could not map " << totalBytes << " bytes" << endl;
+        glDeleteBuffers(1, &_bufferId);
+        _bufferId = 0;
+        return false;
+    }
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Blocks until the GPU has finished the commands that were fenced after the region was last
+    used, and then throws the fence out.  Does nothing if the region has no fence.
+Parameters:
+    regionIndex     Self-explanatory.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+void PersistentRingBuffer::WaitForRegion(unsigned int regionIndex)
+{
+    GLsync fence = static_cast<GLsync>(_fences[regionIndex]);
+    if (fence == 0)
+    {
+        return;
+    }
+
+    // only count (and time) the waits that actually block
+    GLenum waitResult = glClientWaitSync(fence, 0, 0);
+    if (waitResult == GL_TIMEOUT_EXPIRED)
+    {
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+        // flush so that the fence itself is sure to reach the GPU; otherwise this could wait
+        // forever
+        do
+        {
+            waitResult = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                FENCE_TIMEOUT_NANOSECONDS);
+        } while (waitResult == GL_TIMEOUT_EXPIRED);
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+        _fenceWaitSeconds += elapsed.count();
+        _numFenceWaits++;
+    }
+    if (waitResult == GL_WAIT_FAILED)
+    {
+        cout << "PersistentRingBuffer: glClientWaitSync(...) failed" << endl;
+    }
+
+    glDeleteSync(fence);
+    _fences[regionIndex] = 0;
+}
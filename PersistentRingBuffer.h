@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    A buffer for data that changes every frame (transforms, dynamic vertices, particles, and
+    the like).  The buffer is made once with immutable storage (glBufferStorage(...), GL 4.4)
+    and stays mapped, persistently and coherently, for its whole life.  The CPU writes straight
+    into it with no map/unmap or reallocation per frame.
+
+    The buffer is split into regions, usually one per frame in flight.  Each frame writes to
+    the next region (BeginRegion()), draws from it, and puts a fence after those draws
+    (EndRegion()).  When the ring comes back around to a region, its fence is waited on first,
+    so the CPU never overwrites data that the GPU hasn't finished reading.  With 3 regions the
+    wait should almost never block.  Time spent blocked is counted (see FenceWaitSeconds()).
+
+    Note: Coherent mapping means that writes don't need to be flushed, but they must be done
+    before the commands that read them are issued.
+
+    Also Note: Only the thread that owns the OpenGL context may use this.
+-----------------------------------------------------------------------------------------------*/
+class PersistentRingBuffer
+{
+public:
+    PersistentRingBuffer();
+
+    bool Init(size_t bytesPerRegion, unsigned int numRegions, size_t alignment = 1);
+    bool Resize(size_t bytesPerRegion);
+    void *BeginRegion();
+    void EndRegion();
+
+    unsigned int BufferId() const;
+    size_t RegionOffset() const;
+    size_t RegionBytes() const;
+
+    unsigned long long NumRegionsBegun() const;
+    unsigned long long NumFenceWaits() const;
+    double FenceWaitSeconds() const;
+
+private:
+    PersistentRingBuffer(const PersistentRingBuffer &) = delete;
+    PersistentRingBuffer &operator=(const PersistentRingBuffer &) = delete;
+
+    bool Allocate(size_t bytesPerRegion);
+    void WaitForRegion(unsigned int regionIndex);
+
+    // save on the large header inclusion of OpenGL and write out these primitive types
+    // instead of using the OpenGL typedefs
+    // Note: IDs are GLuint (unsigned int), and fences are GLsync (a pointer).
+    unsigned int _bufferId;
+    std::vector<void *> _fences;
+
+    // from glMapBufferRange(...); good until the buffer is replaced
+    char *_mappedBytes;
+
+    // every region's offset is a multiple of the alignment, so its size is rounded up to one
+    size_t _alignment;
+    size_t _regionBytes;
+    unsigned int _numRegions;
+
+    // the region that BeginRegion() last returned, and whether EndRegion() has fenced it since
+    unsigned int _currentRegion;
+    bool _regionOpen;
+
+    unsigned long long _numRegionsBegun;
+    unsigned long long _numFenceWaits;
+    double _fenceWaitSeconds;
+};
@@ -0,0 +1,46 @@
+#include "ProcessMemory.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")   // GetProcessMemoryInfo(...)
+#else
+#include <sys/resource.h>
+#endif
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Gets the largest amount of physical memory (working set on Windows, resident set elsewhere)
+    that this process has had at any one time since it started.
+Parameters: None
+Returns:
+    The peak in bytes, or 0 if the operating system would not say.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+unsigned long long PeakResidentBytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return 0;
+    }
+    return counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+
+#ifdef __APPLE__
+    // already in bytes
+    return static_cast<unsigned long long>(usage.ru_maxrss);
+#else
+    // Linux reports kilobytes
+    return static_cast<unsigned long long>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Asks the operating system how much physical memory this process has used.  This is for
+    the loader's statistics, so that the memory cost of different load options can be compared.
+
+    Note: The peak is a high-water mark for the whole process.  It never goes down, so it only
+    says something about a single load if nothing bigger happened earlier in the process.
+-----------------------------------------------------------------------------------------------*/
+
+unsigned long long PeakResidentBytes();
@@ -0,0 +1,308 @@
+#include "SceneDrawList.h"
+
+#include <map>
+#include <utility>
+#include "glload/include/glload/gl_4_4.h"
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    One entry in the per-instance buffer.  The dequantization's offset and scale are the
+    vertex shader's "positionDequantization" xy and zw, the offset is its "instanceOffset", and
+    the object index is its "objectIndex" (the object's handle, for ObjectTransformBuffer).
+-----------------------------------------------------------------------------------------------*/
+struct InstanceData
+{
+    PositionQuantization _positionDequantization;
+    glm::vec2 _offset;
+    unsigned int _objectIndex;
+};
+static_assert(sizeof(PositionQuantization) == 4 * sizeof(float),
+    "PositionQuantization doesn't match the shader's vec4");
+static_assert(sizeof(InstanceData) == 7 * sizeof(float), "InstanceData is not tightly packed");
+
+// "layout (location = ?)" in the vertex shader, and the buffer binding point that they read
+// from
+// Note: SharedGeometryBuffer's vertices use locations 0 and 1 and binding point 0.
+static const unsigned int DEQUANTIZATION_ATTRIBUTE_LOCATION = 2;
+static const unsigned int INSTANCE_OFFSET_ATTRIBUTE_LOCATION = 3;
+static const unsigned int OBJECT_INDEX_ATTRIBUTE_LOCATION = 4;
+static const unsigned int PER_INSTANCE_BUFFER_BINDING = 1;
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    What glMultiDrawArraysIndirect(...) reads for each draw.  The layout is fixed by OpenGL.
+-----------------------------------------------------------------------------------------------*/
+struct DrawArraysIndirectCommand
+{
+    unsigned int _count;
+    unsigned int _instanceCount;
+    unsigned int _first;
+    unsigned int _baseInstance;
+};
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    What glMultiDrawElementsIndirect(...) reads for each draw.  The layout is fixed by OpenGL.
+-----------------------------------------------------------------------------------------------*/
+struct DrawElementsIndirectCommand
+{
+    unsigned int _count;
+    unsigned int _instanceCount;
+    unsigned int _firstIndex;
+    int _baseVertex;
+    unsigned int _baseInstance;
+};
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Puts a command on the end of the command buffer's contents.
+Parameters:
+    command         DrawArraysIndirectCommand or DrawElementsIndirectCommand.
+    putCommandHere  The command buffer's contents, in 4-byte words (every field is 4 bytes).
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+template<typename INDIRECT_COMMAND>
+static void AppendCommand(const INDIRECT_COMMAND &command,
+    std::vector<unsigned int> *putCommandHere)
+{
+    static_assert(sizeof(INDIRECT_COMMAND) % sizeof(unsigned int) == 0,
+        "indirect commands are made of 4-byte fields");
+    const unsigned int *words = reinterpret_cast<const unsigned int *>(&command);
+    putCommandHere->insert(putCommandHere->end(), words,
+        words + (sizeof(INDIRECT_COMMAND) / sizeof(unsigned int)));
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Ensures that the object starts with initialized values.  Nothing is drawn until Init(...)
+    and Build(...) are called.
+Parameters: None
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+SceneDrawList::SceneDrawList() :
+    _geometryBuffer(0),
+    _commandBufferId(0),
+    _perInstanceBufferId(0),
+    _numCommands(0),
+    _numInstances(0)
+{
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Creates the command buffer and the per-instance buffer, and adds the per-instance
+    attributes to the geometry buffer's vertex array object.
+Parameters:
+    geometryBuffer  Must have been initialized.  It must outlive this object.
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+void SceneDrawList::Init(const SharedGeometryBuffer &geometryBuffer)
+{
+    _geometryBuffer = &geometryBuffer;
+    glGenBuffers(1, &_commandBufferId);
+    glGenBuffers(1, &_perInstanceBufferId);
+
+    // advance once per instance rather than once per vertex, so each instance (counting from
+    // its draw's baseInstance) reads its own entry
+    _geometryBuffer->Bind();
+    glEnableVertexAttribArray(DEQUANTIZATION_ATTRIBUTE_LOCATION);
+    glVertexAttribFormat(DEQUANTIZATION_ATTRIBUTE_LOCATION, 4, GL_FLOAT, GL_FALSE,
+        offsetof(InstanceData, _positionDequantization));
+    glVertexAttribBinding(DEQUANTIZATION_ATTRIBUTE_LOCATION, PER_INSTANCE_BUFFER_BINDING);
+    glEnableVertexAttribArray(INSTANCE_OFFSET_ATTRIBUTE_LOCATION);
+    glVertexAttribFormat(INSTANCE_OFFSET_ATTRIBUTE_LOCATION, 2, GL_FLOAT, GL_FALSE,
+        offsetof(InstanceData, _offset));
+    glVertexAttribBinding(INSTANCE_OFFSET_ATTRIBUTE_LOCATION, PER_INSTANCE_BUFFER_BINDING);
+    glEnableVertexAttribArray(OBJECT_INDEX_ATTRIBUTE_LOCATION);
+    glVertexAttribIFormat(OBJECT_INDEX_ATTRIBUTE_LOCATION, 1, GL_UNSIGNED_INT,
+        offsetof(InstanceData, _objectIndex));
+    glVertexAttribBinding(OBJECT_INDEX_ATTRIBUTE_LOCATION, PER_INSTANCE_BUFFER_BINDING);
+    glVertexBindingDivisor(PER_INSTANCE_BUFFER_BINDING, 1);
+    glBindVertexBuffer(PER_INSTANCE_BUFFER_BINDING, _perInstanceBufferId, 0,
+        sizeof(InstanceData));
+    glBindVertexArray(0);
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Rebuilds the draw commands from every object in the scene.  Call whenever objects are
+    added; drawing an unchanged scene doesn't need it.
+
+    Note: The objects are grouped by draw style and index type, since those can't change within
+    a multi-draw call.  A std::map keeps the groups (and so the draw order) the same from one
+    build to the next.
+
+    Also Note: Instances (see GeometryData::_instanceOf) don't get commands of their own.  They
+    are added to their original's instance count.
+Parameters:
+    geometry    The scene.  Every object in it must have been uploaded to the geometry buffer.
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+void SceneDrawList::Build(const GeometryRegistry &geometry)
+{
+    typedef std::pair<unsigned int, unsigned int> GROUP_KEY;
+    std::map<GROUP_KEY, std::vector<GeometryRegistry::HANDLE>> handlesByGroup;
+    std::vector<std::vector<GeometryRegistry::HANDLE>> copiesByHandle(geometry.Size());
+    for (GeometryRegistry::HANDLE handle = 0; handle < geometry.Size(); handle++)
+    {
+        const GeometryData &geometryData = geometry.Geometry(handle);
+        if (geometryData._instanceOf != GeometryRegistry::NO_HANDLE)
+        {
+            copiesByHandle[geometryData._instanceOf].push_back(handle);
+            continue;
+        }
+        if (geometryData._drawCount == 0)
+        {
+            continue;
+        }
+
+        unsigned int indexType = geometryData._indices.empty() ? 0 : geometryData._indexType;
+        handlesByGroup[GROUP_KEY(geometryData._drawStyle, indexType)].push_back(handle);
+    }
+
+    std::vector<unsigned int> commandWords;
+    std::vector<InstanceData> perInstance;
+    perInstance.reserve(geometry.Size());
+    _groups.clear();
+    _numCommands = 0;
+    for (auto itr = handlesByGroup.begin(); itr != handlesByGroup.end(); itr++)
+    {
+        DrawGroup group;
+        group._drawStyle = itr->first.first;
+        group._indexType = itr->first.second;
+        group._commandOffsetBytes = commandWords.size() * sizeof(unsigned int);
+        group._numCommands = static_cast<unsigned int>(itr->second.size());
+
+        for (size_t handleIndex = 0; handleIndex < itr->second.size(); handleIndex++)
+        {
+            GeometryRegistry::HANDLE handle = itr->second[handleIndex];
+            const GeometryData &geometryData = geometry.Geometry(handle);
+            unsigned int baseInstance = static_cast<unsigned int>(perInstance.size());
+
+            // the object itself, then its copies
+            InstanceData instance =
+            {
+                geometryData._positionDequantization, glm::vec2(),
+                static_cast<unsigned int>(handle)
+            };
+            perInstance.push_back(instance);
+            const std::vector<GeometryRegistry::HANDLE> &copies = copiesByHandle[handle];
+            for (size_t copyIndex = 0; copyIndex < copies.size(); copyIndex++)
+            {
+                instance._offset = geometry.Geometry(copies[copyIndex])._instanceOffset;
+                instance._objectIndex = static_cast<unsigned int>(copies[copyIndex]);
+                perInstance.push_back(instance);
+            }
+            unsigned int instanceCount =
+                static_cast<unsigned int>(perInstance.size()) - baseInstance;
+
+            if (group._indexType == 0)
+            {
+                DrawArraysIndirectCommand command =
+                {
+                    geometryData._drawCount, instanceCount, geometryData._baseVertex,
+                    baseInstance
+                };
+                AppendCommand(command, &commandWords);
+            }
+            else
+            {
+                DrawElementsIndirectCommand command =
+                {
+                    geometryData._drawCount, instanceCount, geometryData._firstIndex,
+                    static_cast<int>(geometryData._baseVertex), baseInstance
+                };
+                AppendCommand(command, &commandWords);
+            }
+        }
+
+        _numCommands += group._numCommands;
+        _groups.push_back(group);
+    }
+    _numInstances = perInstance.size();
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _commandBufferId);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, commandWords.size() * sizeof(unsigned int),
+        commandWords.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    // the VAO refers to the buffer by ID, so new storage for it doesn't need a new binding
+    glBindBuffer(GL_ARRAY_BUFFER, _perInstanceBufferId);
+    glBufferData(GL_ARRAY_BUFFER, perInstance.size() * sizeof(InstanceData),
+        perInstance.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Draws the whole scene as of the last Build(...).  The caller binds the program.
+
+    Note: Leaves the geometry buffer's vertex array object bound.
+Parameters: None
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+void SceneDrawList::Draw() const
+{
+    if (_groups.empty())
+    {
+        return;
+    }
+
+    _geometryBuffer->Bind();
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _commandBufferId);
+    for (size_t groupIndex = 0; groupIndex < _groups.size(); groupIndex++)
+    {
+        const DrawGroup &group = _groups[groupIndex];
+        if (group._indexType == 0)
+        {
+            glMultiDrawArraysIndirect(group._drawStyle, (void *)group._commandOffsetBytes,
+                group._numCommands, 0);
+        }
+        else
+        {
+            glMultiDrawElementsIndirect(group._drawStyle, group._indexType,
+                (void *)group._commandOffsetBytes, group._numCommands, 0);
+        }
+    }
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Self-explanatory.
+Parameters: None
+Returns:
+    The number of glMultiDraw*Indirect(...) calls that Draw() makes.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+size_t SceneDrawList::NumMultiDrawCalls() const
+{
+    return _groups.size();
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Self-explanatory.
+Parameters: None
+Returns:
+    The number of meshes that Draw() draws (one command each).
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+size_t SceneDrawList::NumCommands() const
+{
+    return _numCommands;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Self-explanatory.
+Parameters: None
+Returns:
+    The number of objects that Draw() draws, counting each translated copy.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+size_t SceneDrawList::NumInstances() const
+{
+    return _numInstances;
+}
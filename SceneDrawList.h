@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+#include "GeometryRegistry.h"
+#include "SharedGeometryBuffer.h"
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Draws every object in the scene with one glMultiDrawArraysIndirect(...) or
+    glMultiDrawElementsIndirect(...) per draw style (and index type), so the cost of submitting
+    a frame doesn't grow with the number of objects.
+
+    The draw commands are kept in a GL_DRAW_INDIRECT_BUFFER and are only rebuilt when the scene
+    changes (see Build(...)).  Each command's baseInstance picks the object's first entry in a
+    per-instance buffer, which the vertex shader reads as instanced attributes ("layout
+    (location = 2) in vec4 positionDequantization", "layout (location = 3) in vec2
+    instanceOffset", and "layout (location = 4) in uint objectIndex"), since a uniform can't
+    change part way through a multi-draw.  The object index is the object's handle, which
+    picks its transform (see ObjectTransformBuffer).
+
+    An object's translated copies (see TranslatedCopies.h) are drawn by the object's own
+    command as more instances, each with its own offset.
+
+    Note: Every object must have been added to the same SharedGeometryBuffer, which is the one
+    given to Init(...).
+
+    Also Note: Only the thread that owns the OpenGL context may use this.
+-----------------------------------------------------------------------------------------------*/
+class SceneDrawList
+{
+public:
+    SceneDrawList();
+
+    void Init(const SharedGeometryBuffer &geometryBuffer);
+    void Build(const GeometryRegistry &geometry);
+    void Draw() const;
+
+    size_t NumMultiDrawCalls() const;
+    size_t NumCommands() const;
+    size_t NumInstances() const;
+
+private:
+    SceneDrawList(const SceneDrawList &) = delete;
+    SceneDrawList &operator=(const SceneDrawList &) = delete;
+
+    /*-------------------------------------------------------------------------------------------
+    Description:
+        The commands for one multi-draw call, which all have the same draw style and index
+        type.
+    -------------------------------------------------------------------------------------------*/
+    struct DrawGroup
+    {
+        unsigned int _drawStyle;
+
+        // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT (GLenum), or 0 for glMultiDrawArraysIndirect(...)
+        unsigned int _indexType;
+
+        // where the group's commands start in the command buffer
+        size_t _commandOffsetBytes;
+        unsigned int _numCommands;
+    };
+
+    const SharedGeometryBuffer *_geometryBuffer;
+
+    // save on the large header inclusion of OpenGL and write out these primitive types
+    // instead of using the OpenGL typedefs
+    // Note: IDs are GLuint (unsigned int).
+    unsigned int _commandBufferId;
+    unsigned int _perInstanceBufferId;
+
+    std::vector<DrawGroup> _groups;
+    size_t _numCommands;
+    size_t _numInstances;
+};
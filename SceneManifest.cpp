@@ -0,0 +1,294 @@
+#include "SceneManifest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include "ProcessMemory.h"
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Ensures that the statistics start out zeroed.
+Parameters: None
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+SceneManifest::FileStatistics::FileStatistics() :
+    _succeeded(false),
+    _numObjects(0)
+{
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Tells a manifest apart from an .obj file.
+Parameters:
+    filePath    Self-explanatory.
+Returns:
+    True if the path ends in ".scene", otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool SceneManifest::IsManifestPath(const std::string &filePath)
+{
+    static const std::string extension = ".scene";
+    return filePath.length() > extension.length() &&
+        filePath.compare(filePath.length() - extension.length(), extension.length(),
+        extension) == 0;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Makes a path from the manifest relative to the manifest's folder (unless it is absolute).
+Parameters:
+    manifestPath    Self-explanatory.
+    filePath        As written in the manifest.
+Returns:
+    The path to use.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static std::string ResolveManifestPath(const std::string &manifestPath,
+    const std::string &filePath)
+{
+    // "/...", "\...", and "C:..." are absolute
+    bool isAbsolute = (filePath[0] == '/') || (filePath[0] == '\\') ||
+        (filePath.length() > 1 && filePath[1] == ':');
+    size_t folderEnd = manifestPath.find_last_of("/\\");
+    if (isAbsolute || folderEnd == std::string::npos)
+    {
+        return filePath;
+    }
+
+    return manifestPath.substr(0, folderEnd + 1) + filePath;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Reads a manifest (see the class description).
+Parameters:
+    manifestPath    Self-explanatory.
+    putEntriesHere  Cleared, then gets one entry per .obj file, in manifest order.
+Returns:
+    True if the manifest was read and every line made sense, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool SceneManifest::Read(const std::string &manifestPath, std::vector<Entry> *putEntriesHere)
+{
+    putEntriesHere->clear();
+    std::ifstream manifestFile(manifestPath, std::ios::in);
+    if (!manifestFile.is_open())
+    {
+        cout << "Could not find the scene manifest: " << manifestPath << endl;
+        return false;
+    }
+
+    static const char whitespace[] = " \t\r";
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(manifestFile, line))
+    {
+        lineNumber++;
+        size_t pathBegin = line.find_first_not_of(whitespace);
+        if (pathBegin == std::string::npos || line[pathBegin] == '#')
+        {
+            continue;
+        }
+
+        size_t pathEnd = 0;
+        size_t restBegin = 0;
+        if (line[pathBegin] == '"')
+        {
+            pathBegin++;
+            pathEnd = line.find('"', pathBegin);
+            if (pathEnd == std::string::npos)
+            {
+                cout << manifestPath << "(" << lineNumber << "): missing closing quote" << endl;
+                return false;
+            }
+            restBegin = pathEnd + 1;
+        }
+        else
+        {
+            pathEnd = std::min(line.find_first_of(whitespace, pathBegin), line.length());
+            restBegin = pathEnd;
+        }
+
+        if (pathEnd == pathBegin)
+        {
+            cout << manifestPath << "(" << lineNumber << "): empty file path" << endl;
+            return false;
+        }
+
+        Entry entry;
+        entry._filePath = ResolveManifestPath(manifestPath,
+            line.substr(pathBegin, pathEnd - pathBegin));
+
+        size_t prefixBegin = line.find_first_not_of(whitespace, restBegin);
+        if (prefixBegin != std::string::npos)
+        {
+            size_t prefixEnd = line.find_last_not_of(whitespace) + 1;
+            entry._namePrefix = line.substr(prefixBegin, prefixEnd - prefixBegin);
+        }
+
+        putEntriesHere->push_back(entry);
+    }
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Loads every file in the manifest with BlenderLoad::LoadObj(...) and merges the objects
+    into one collection.  Each worker thread takes the next file that nobody has started on,
+    so a few big files don't hold up the small ones.
+
+    Note: Every file is loaded into its own collection, and those are only merged (on this
+    thread, in manifest order) once all of the files are done.  The merged names never depend
+    on which thread finished first.
+
+    Also Note: options are used for each file, so LoadOptions::_numThreads threads are used
+    per file on top of the file threads.  Leave it at 1 for a scene with more files than
+    hardware threads.
+Parameters:
+    entries         From Read(...).
+    options         Passed on to BlenderLoad::LoadObj(...) for each file.
+    numFileThreads  How many files to load at once.  0 means one per hardware thread.  Never
+                    more than the number of files.
+    putDataHere     Gets the objects from every file that loaded, with their names prefixed.
+    fileStats       Optional.  Cleared, then gets one entry per file, in manifest order.
+    totalStats      Optional.  The sums of the bytes parsed, the line counts, and the phase
+                    times, plus how long the whole scene took and the peak memory use.  The
+                    welding and quantization results are renamed to match the merged names.
+Returns:
+    True if every file loaded, otherwise false.  The files that did load are merged either
+    way.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool SceneManifest::Load(const std::vector<Entry> &entries,
+    const BlenderLoad::LoadOptions &options, unsigned int numFileThreads,
+    BlenderLoad::GEOMETRY_DATA_BY_NAME *putDataHere, std::vector<FileStatistics> *fileStats,
+    BlenderLoad::LoadStatistics *totalStats)
+{
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    if (numFileThreads == 0)
+    {
+        // may return 0 if it can't tell
+        numFileThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    numFileThreads = static_cast<unsigned int>(
+        std::min(static_cast<size_t>(numFileThreads), entries.size()));
+
+    std::vector<BlenderLoad::GEOMETRY_DATA_BY_NAME> geometryByFile(entries.size());
+    std::vector<FileStatistics> statsByFile(entries.size());
+    std::atomic<size_t> nextEntryIndex(0);
+    auto loadFiles = [&]()
+    {
+        for (size_t entryIndex = nextEntryIndex++; entryIndex < entries.size();
+            entryIndex = nextEntryIndex++)
+        {
+            FileStatistics &stats = statsByFile[entryIndex];
+            stats._filePath = entries[entryIndex]._filePath;
+            stats._succeeded = BlenderLoad::LoadObj(stats._filePath,
+                &geometryByFile[entryIndex], options, &stats._stats);
+            stats._numObjects = geometryByFile[entryIndex].Size();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned int threadIndex = 1; threadIndex < numFileThreads; threadIndex++)
+    {
+        workers.push_back(std::thread(loadFiles));
+    }
+    loadFiles();
+    for (size_t threadIndex = 0; threadIndex < workers.size(); threadIndex++)
+    {
+        workers[threadIndex].join();
+    }
+
+    // merge in manifest order
+    bool success = true;
+    BlenderLoad::LoadStatistics mergedStats;
+    mergedStats._loadedFromCache = !entries.empty();
+    for (size_t entryIndex = 0; entryIndex < entries.size(); entryIndex++)
+    {
+        const FileStatistics &stats = statsByFile[entryIndex];
+        success = success && stats._succeeded;
+
+        // only text that was actually parsed counts towards the scene's throughput
+        mergedStats._loadedFromCache =
+            mergedStats._loadedFromCache && stats._stats._loadedFromCache;
+        if (!stats._stats._loadedFromCache)
+        {
+            mergedStats._bytesParsed += stats._stats._bytesParsed;
+        }
+        mergedStats._compressedBytes += stats._stats._compressedBytes;
+        mergedStats._prescanSeconds += stats._stats._prescanSeconds;
+        mergedStats._weldSeconds += stats._stats._weldSeconds;
+        mergedStats._cacheSeconds += stats._stats._cacheSeconds;
+        mergedStats._lineCounts.Add(stats._stats._lineCounts);
+        mergedStats._numVertsEmitted += stats._stats._numVertsEmitted;
+        const std::vector<std::string> &samples = stats._stats._unknownLineSamples;
+        for (size_t sampleIndex = 0; sampleIndex < samples.size() &&
+            mergedStats._unknownLineSamples.size() < options._maxUnknownLineSamples;
+            sampleIndex++)
+        {
+            mergedStats._unknownLineSamples.push_back(samples[sampleIndex]);
+        }
+        if (!stats._succeeded)
+        {
+            cout << "Could not load '" << stats._filePath << "' for the scene" << endl;
+            continue;
+        }
+
+        const std::string &namePrefix = entries[entryIndex]._namePrefix;
+        BlenderLoad::GEOMETRY_DATA_BY_NAME &fileGeometry = geometryByFile[entryIndex];
+
+        // the file's welding and quantization results are in the same order as its collection
+        const std::vector<BlenderLoad::WeldStatistics> &weldStats = stats._stats._weldStats;
+        const std::vector<BlenderLoad::QuantizationStatistics> &quantizationStats =
+            stats._stats._quantizationStats;
+        putDataHere->Reserve(putDataHere->Size() + fileGeometry.Size());
+        for (GeometryRegistry::HANDLE handle = 0; handle < fileGeometry.Size(); handle++)
+        {
+            std::string objectName = BlenderLoad::UniqueObjectName(
+                namePrefix + fileGeometry.Name(handle), *putDataHere);
+            putDataHere->Geometry(putDataHere->Add(objectName)) =
+                std::move(fileGeometry.Geometry(handle));
+
+            if (handle < weldStats.size())
+            {
+                mergedStats._weldStats.push_back(weldStats[handle]);
+                mergedStats._weldStats.back()._objectName = objectName;
+            }
+            if (handle < quantizationStats.size())
+            {
+                mergedStats._quantizationStats.push_back(quantizationStats[handle]);
+                mergedStats._quantizationStats.back()._objectName = objectName;
+            }
+        }
+
+        // no longer needed, so give the memory back
+        fileGeometry.Clear();
+    }
+
+    if (totalStats != 0)
+    {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+        mergedStats._parseSeconds = elapsed.count();
+        mergedStats._numObjects = putDataHere->Size();
+        mergedStats._peakResidentBytes = PeakResidentBytes();
+        *totalStats = mergedStats;
+    }
+
+    if (fileStats != 0)
+    {
+        fileStats->swap(statsByFile);
+    }
+
+    return success;
+}
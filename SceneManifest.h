@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "BlenderLoad.h"
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    A scene that is put together from several .obj files.  The manifest is a text file with one
+    .obj file per line, optionally followed by a prefix for the names of that file's objects:
+
+        # comments and blank lines are skipped
+        trees.obj.gz        Trees/
+        "my house.obj"      House/
+        ground.obj
+
+    Relative paths are relative to the manifest's folder.  Paths with spaces need quotes.
+
+    The files are loaded in parallel, one file per thread, and merged in manifest order.
+    Objects whose (prefixed) names collide with an object from an earlier file get a
+    ".001"-style suffix (see BlenderLoad::UniqueObjectName(...)), so the result is the same no
+    matter which file finishes first.
+-----------------------------------------------------------------------------------------------*/
+class SceneManifest
+{
+public:
+    /*-------------------------------------------------------------------------------------------
+    Description:
+        One line of the manifest.
+    -------------------------------------------------------------------------------------------*/
+    struct Entry
+    {
+        std::string _filePath;
+        std::string _namePrefix;
+    };
+
+    /*-------------------------------------------------------------------------------------------
+    Description:
+        How loading one of the files went, so that slow assets can be found.
+    -------------------------------------------------------------------------------------------*/
+    struct FileStatistics
+    {
+        FileStatistics();
+
+        std::string _filePath;
+        bool _succeeded;
+        size_t _numObjects;
+
+        // from BlenderLoad::LoadObj(...) for this file alone
+        BlenderLoad::LoadStatistics _stats;
+    };
+
+    static bool IsManifestPath(const std::string &filePath);
+    static bool Read(const std::string &manifestPath, std::vector<Entry> *putEntriesHere);
+    static bool Load(const std::vector<Entry> &entries, const BlenderLoad::LoadOptions &options,
+        unsigned int numFileThreads, BlenderLoad::GEOMETRY_DATA_BY_NAME *putDataHere,
+        std::vector<FileStatistics> *fileStats = 0, BlenderLoad::LoadStatistics *totalStats = 0);
+};
@@ -0,0 +1,263 @@
+#include "SharedGeometryBuffer.h"
+
+#include "glload/include/glload/gl_4_4.h"
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+static_assert(VERTEX_COMPONENT_SHORT == GL_SHORT, "VERTEX_COMPONENT_SHORT is wrong");
+static_assert(VERTEX_COMPONENT_UNSIGNED_SHORT == GL_UNSIGNED_SHORT,
+    "VERTEX_COMPONENT_UNSIGNED_SHORT is wrong");
+static_assert(VERTEX_COMPONENT_FLOAT == GL_FLOAT, "VERTEX_COMPONENT_FLOAT is wrong");
+static_assert(VERTEX_COMPONENT_INT_2_10_10_10_REV == GL_INT_2_10_10_10_REV,
+    "VERTEX_COMPONENT_INT_2_10_10_10_REV is wrong");
+
+// every vertex attribute reads from this binding point (see glVertexAttribBinding(...))
+static const unsigned int VERTEX_BUFFER_BINDING = 0;
+
+// the buffers start out this big and double whenever they run out
+// Note: Big enough for the sample scenes without ever growing.
+static const size_t INITIAL_BUFFER_SIZE_BYTES = 1024 * 1024;
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Ensures that the object starts with initialized values.  Nothing is created until
+    Init(...) is called.
+Parameters: None
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+SharedGeometryBuffer::SharedGeometryBuffer() :
+    _vaoId(0),
+    _vertexBufferId(0),
+    _elementBufferId(0),
+    _quantize(false),
+    _bytesPerVertex(0),
+    _vertexBytesCapacity(0),
+    _vertexBytesUsed(0),
+    _indexBytesCapacity(0),
+    _indexBytesUsed(0)
+{
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Creates the buffers and the vertex array object.
+
+    Note: Uses a layout that fits every draw style (see VertexLayout.h), since every object
+    has to share it.  Use InitWithLayout(...) to pick a different one.
+Parameters:
+    quantize    True to upload Vertex2DQuantized (positions relative to each object's bounds),
+                otherwise Vertex2DPackedNormal.
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+void SharedGeometryBuffer::Init(bool quantize)
+{
+    _quantize = quantize;
+    if (quantize)
+    {
+        InitWithLayout<Vertex2DQuantized>();
+    }
+    else
+    {
+        InitWithLayout<Vertex2DPackedNormal>();
+    }
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Converts an object's vertices to the layout that Init(...) picked and copies them (and its
+    indices, if any) onto the end of the shared buffers.
+Parameters:
+    geometryData    Its upload fields (see GeometryData::_baseVertex) are filled in.
+Returns:
+    True if the object was uploaded, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool SharedGeometryBuffer::Add(GeometryData *geometryData)
+{
+    if (_quantize)
+    {
+        return AddWithLayout<Vertex2DQuantized>(geometryData);
+    }
+    else
+    {
+        return AddWithLayout<Vertex2DPackedNormal>(geometryData);
+    }
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Binds the vertex array object, which also binds the element buffer.  Every object that
+    was added can then be drawn without binding anything else.
+Parameters: None
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+void SharedGeometryBuffer::Bind() const
+{
+    glBindVertexArray(_vaoId);
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Does the OpenGL work for InitWithLayout(...).  It is not a template so that OpenGL stays
+    out of SharedGeometryBuffer.h.
+
+    Note: With separate attribute formats the vertex array object doesn't look at the program
+    or at GL_ARRAY_BUFFER, so no program has to be bound.
+Parameters:
+    bytesPerVertex  The size of one vertex in the layout.
+    attributes      The layout's attribute table.
+    numAttributes   Self-explanatory.
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+void SharedGeometryBuffer::InitArrays(unsigned int bytesPerVertex,
+    const VertexAttribute *attributes, unsigned int numAttributes)
+{
+    _bytesPerVertex = bytesPerVertex;
+
+    glGenVertexArrays(1, &_vaoId);
+    glBindVertexArray(_vaoId);
+    for (unsigned int attributeIndex = 0; attributeIndex < numAttributes; attributeIndex++)
+    {
+        const VertexAttribute &attribute = attributes[attributeIndex];
+        glEnableVertexAttribArray(attribute._location);
+        glVertexAttribFormat(attribute._location, attribute._numComponents,
+            attribute._componentType, attribute._normalized ? GL_TRUE : GL_FALSE,
+            attribute._offsetBytes);
+        glVertexAttribBinding(attribute._location, VERTEX_BUFFER_BINDING);
+    }
+    glBindVertexArray(0);
+
+    Reserve(GL_ARRAY_BUFFER, INITIAL_BUFFER_SIZE_BYTES, &_vertexBufferId,
+        &_vertexBytesCapacity);
+    Reserve(GL_ELEMENT_ARRAY_BUFFER, INITIAL_BUFFER_SIZE_BYTES, &_elementBufferId,
+        &_indexBytesCapacity);
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Does the OpenGL work for AddWithLayout(...).  The vertices go on the end of the vertex
+    buffer, and the indices go on the end of the element buffer, narrowed to 16 bits if the
+    object's index type says so.
+Parameters:
+    vertData        The vertices, already converted to the layout.
+    bytesPerVertex  The size of one vertex in the layout.
+    geometryData    Its upload fields (see GeometryData::_baseVertex) are filled in.
+Returns:
+    True if the object was uploaded, otherwise false (the layout doesn't match Init(...)'s).
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool SharedGeometryBuffer::AddData(const void *vertData, unsigned int bytesPerVertex,
+    GeometryData *geometryData)
+{
+    if (bytesPerVertex != _bytesPerVertex)
+    {
+        cout << "SharedGeometryBuffer: vertex layout is " << bytesPerVertex <<
+            " bytes, but the buffer was set up for " << _bytesPerVertex << endl;
+        return false;
+    }
+
+    size_t numVertBytes = geometryData->_verts.size() * bytesPerVertex;
+    Reserve(GL_ARRAY_BUFFER, _vertexBytesUsed + numVertBytes, &_vertexBufferId,
+        &_vertexBytesCapacity);
+    glBindBuffer(GL_ARRAY_BUFFER, _vertexBufferId);
+    glBufferSubData(GL_ARRAY_BUFFER, _vertexBytesUsed, numVertBytes, vertData);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    geometryData->_baseVertex = static_cast<unsigned int>(_vertexBytesUsed / bytesPerVertex);
+    _vertexBytesUsed += numVertBytes;
+
+    const std::vector<unsigned int> &indices = geometryData->_indices;
+    if (indices.empty())
+    {
+        geometryData->_firstIndex = 0;
+        geometryData->_drawCount = static_cast<unsigned int>(geometryData->_verts.size());
+        return true;
+    }
+
+    // an index has to start at a multiple of its own size, so a 32-bit object may have to skip
+    // 2 bytes after a 16-bit object with an odd number of indices
+    bool shortIndices = (geometryData->_indexType == GL_UNSIGNED_SHORT);
+    size_t indexSizeBytes = shortIndices ? sizeof(unsigned short) : sizeof(unsigned int);
+    size_t indexStartBytes = (_indexBytesUsed + indexSizeBytes - 1) / indexSizeBytes *
+        indexSizeBytes;
+    size_t numIndexBytes = indices.size() * indexSizeBytes;
+    Reserve(GL_ELEMENT_ARRAY_BUFFER, indexStartBytes + numIndexBytes, &_elementBufferId,
+        &_indexBytesCapacity);
+
+    // the element buffer binding belongs to the VAO, so GL_COPY_WRITE_BUFFER is used instead
+    // to keep from disturbing it
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _elementBufferId);
+    if (shortIndices)
+    {
+        std::vector<unsigned short> narrowIndices(indices.begin(), indices.end());
+        glBufferSubData(GL_COPY_WRITE_BUFFER, indexStartBytes, numIndexBytes,
+            narrowIndices.data());
+    }
+    else
+    {
+        glBufferSubData(GL_COPY_WRITE_BUFFER, indexStartBytes, numIndexBytes, indices.data());
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    geometryData->_firstIndex = static_cast<unsigned int>(indexStartBytes / indexSizeBytes);
+    geometryData->_drawCount = static_cast<unsigned int>(indices.size());
+    _indexBytesUsed = indexStartBytes + numIndexBytes;
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Makes sure that one of the shared buffers can hold at least the given number of bytes.
+    If it can't, it is replaced by one at least twice as big, the data is copied over on the
+    GPU, and the vertex array object is pointed at the new one.
+Parameters:
+    target          GL_ARRAY_BUFFER for the vertex buffer or GL_ELEMENT_ARRAY_BUFFER for the
+                    element buffer.
+    numBytes        Self-explanatory.
+    bufferId        0 if the buffer doesn't exist yet.  Updated.
+    capacityBytes   The buffer's current size.  Updated.
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+void SharedGeometryBuffer::Reserve(unsigned int target, size_t numBytes,
+    unsigned int *bufferId, size_t *capacityBytes)
+{
+    if (*bufferId != 0 && numBytes <= *capacityBytes)
+    {
+        return;
+    }
+
+    size_t newCapacityBytes = (*capacityBytes > 0) ? *capacityBytes : numBytes;
+    while (newCapacityBytes < numBytes)
+    {
+        newCapacityBytes *= 2;
+    }
+
+    unsigned int newBufferId = 0;
+    glGenBuffers(1, &newBufferId);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newBufferId);
+    glBufferData(GL_COPY_WRITE_BUFFER, newCapacityBytes, 0, GL_STATIC_DRAW);
+    size_t bytesUsed = (target == GL_ARRAY_BUFFER) ? _vertexBytesUsed : _indexBytesUsed;
+    if (*bufferId != 0)
+    {
+        glBindBuffer(GL_COPY_READ_BUFFER, *bufferId);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, bytesUsed);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glDeleteBuffers(1, bufferId);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    // the attribute formats don't change, only where they read from
+    glBindVertexArray(_vaoId);
+    if (target == GL_ARRAY_BUFFER)
+    {
+        glBindVertexBuffer(VERTEX_BUFFER_BINDING, newBufferId, 0, _bytesPerVertex);
+    }
+    else
+    {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, newBufferId);
+    }
+    glBindVertexArray(0);
+
+    *bufferId = newBufferId;
+    *capacityBytes = newCapacityBytes;
+}
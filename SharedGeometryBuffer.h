@@ -0,0 +1,110 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+#include "GeometryData.h"
+#include "VertexLayout.h"
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    One vertex buffer and one element buffer that every object in the scene is packed into, and
+    the one vertex array object that describes them.  Drawing the whole scene then takes a
+    single glBindVertexArray(...), and each object is drawn from its own range of the buffers
+    (see GeometryData::_baseVertex).
+
+    The VAO uses separate attribute formats (glVertexAttribFormat(...) and
+    glBindVertexBuffer(...), GL 4.3), so the attribute formats are set up once.  When a buffer
+    fills up it is replaced by a larger one, and only the buffer binding has to change.
+
+    Note: Every object in the buffer has the same vertex layout (see VertexLayout.h), which is
+    picked once by Init(...).  Objects keep their own index type.  16-bit and 32-bit indices
+    share the element buffer, with each object's indices aligned to their own size.
+
+    Also Note: Only the thread that owns the OpenGL context may use this.
+-----------------------------------------------------------------------------------------------*/
+class SharedGeometryBuffer
+{
+public:
+    SharedGeometryBuffer();
+
+    void Init(bool quantize = false);
+    bool Add(GeometryData *geometryData);
+    void Bind() const;
+
+    template<typename VERTEX_LAYOUT>
+    void InitWithLayout();
+    template<typename VERTEX_LAYOUT>
+    bool AddWithLayout(GeometryData *geometryData);
+
+private:
+    SharedGeometryBuffer(const SharedGeometryBuffer &) = delete;
+    SharedGeometryBuffer &operator=(const SharedGeometryBuffer &) = delete;
+
+    void InitArrays(unsigned int bytesPerVertex, const VertexAttribute *attributes,
+        unsigned int numAttributes);
+    bool AddData(const void *vertData, unsigned int bytesPerVertex,
+        GeometryData *geometryData);
+    void Reserve(unsigned int target, size_t numBytes, unsigned int *bufferId,
+        size_t *capacityBytes);
+
+    // save on the large header inclusion of OpenGL and write out these primitive types
+    // instead of using the OpenGL typedefs
+    // Note: IDs are GLuint (unsigned int).
+    unsigned int _vaoId;
+    unsigned int _vertexBufferId;
+    unsigned int _elementBufferId;
+
+    // from Init(...); Add(...) uploads Vertex2DQuantized if true, otherwise
+    // Vertex2DPackedNormal
+    bool _quantize;
+
+    // the size of the layout that InitWithLayout(...) was given; 0 before that
+    unsigned int _bytesPerVertex;
+
+    // the buffers' sizes and how much of them is taken, in bytes
+    size_t _vertexBytesCapacity;
+    size_t _vertexBytesUsed;
+    size_t _indexBytesCapacity;
+    size_t _indexBytesUsed;
+};
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Like Init(...), but for any vertex layout (see VertexLayout.h).  Objects must then be added
+    with AddWithLayout(...) and the same layout.
+Parameters: None
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+template<typename VERTEX_LAYOUT>
+void SharedGeometryBuffer::InitWithLayout()
+{
+    InitArrays(sizeof(VERTEX_LAYOUT), VERTEX_LAYOUT::ATTRIBUTES, VERTEX_LAYOUT::NUM_ATTRIBUTES);
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Like Add(...), but the vertices are converted to the given layout, which must be the one
+    that InitWithLayout(...) was given.  _verts is left as it is.
+Parameters:
+    geometryData    Its upload fields (see GeometryData::_baseVertex) are filled in.
+Returns:
+    True if the object was uploaded, otherwise false (the layout doesn't match).
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+template<typename VERTEX_LAYOUT>
+bool SharedGeometryBuffer::AddWithLayout(GeometryData *geometryData)
+{
+    geometryData->_positionDequantization = VERTEX_LAYOUT::QUANTIZED_POSITIONS ?
+        PositionQuantizationForBounds(geometryData->_verts) : PositionQuantization();
+
+    std::vector<VERTEX_LAYOUT> layoutVerts;
+    layoutVerts.reserve(geometryData->_verts.size());
+    for (size_t vertIndex = 0; vertIndex < geometryData->_verts.size(); vertIndex++)
+    {
+        layoutVerts.push_back(VERTEX_LAYOUT(geometryData->_verts[vertIndex],
+            geometryData->_positionDequantization));
+    }
+
+    return AddData(layoutVerts.data(), sizeof(VERTEX_LAYOUT), geometryData);
+}
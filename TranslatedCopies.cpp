@@ -0,0 +1,288 @@
+#include "TranslatedCopies.h"
+
+#include <math.h>
+#include "GeometryCache.h"
+
+// the bounding box's size is rounded down to a multiple of this for the hash
+// Note: Must be well over twice TRANSLATED_COPY_TOLERANCE so that a copy's size and its
+// original's, which can differ by that much, never fall more than one cell apart.
+static constexpr float EXTENT_CELL_SIZE = 0.001f;
+static_assert(EXTENT_CELL_SIZE > 4.0f * TRANSLATED_COPY_TOLERANCE,
+    "extent cells are too small for the tolerance");
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Self-explanatory.
+Parameters:
+    verts       Self-explanatory.
+Returns:
+    The average X and Y of the vertices, or (0, 0) if there aren't any.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static glm::vec2 Centroid(const std::vector<MyVertex> &verts)
+{
+    if (verts.empty())
+    {
+        return glm::vec2(0.0f, 0.0f);
+    }
+
+    // doubles so that a big object doesn't pick up rounding error in the sum
+    double sumX = 0.0;
+    double sumY = 0.0;
+    for (size_t vertIndex = 0; vertIndex < verts.size(); vertIndex++)
+    {
+        sumX += verts[vertIndex]._position.x;
+        sumY += verts[vertIndex]._position.y;
+    }
+    return glm::vec2(static_cast<float>(sumX / verts.size()),
+        static_cast<float>(sumY / verts.size()));
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Self-explanatory.
+Parameters:
+    verts       Self-explanatory.
+Returns:
+    The width and height of the vertices' bounding box, or (0, 0) if there aren't any.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static glm::vec2 Extent(const std::vector<MyVertex> &verts)
+{
+    if (verts.empty())
+    {
+        return glm::vec2(0.0f, 0.0f);
+    }
+
+    glm::vec2 boundsMin(verts[0]._position.x, verts[0]._position.y);
+    glm::vec2 boundsMax = boundsMin;
+    for (size_t vertIndex = 1; vertIndex < verts.size(); vertIndex++)
+    {
+        const glm::vec4 &position = verts[vertIndex]._position;
+        boundsMin.x = (position.x < boundsMin.x) ? position.x : boundsMin.x;
+        boundsMin.y = (position.y < boundsMin.y) ? position.y : boundsMin.y;
+        boundsMax.x = (position.x > boundsMax.x) ? position.x : boundsMax.x;
+        boundsMax.y = (position.y > boundsMax.y) ? position.y : boundsMax.y;
+    }
+    return boundsMax - boundsMin;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Combines the parts of an object that translation can't change into a single hash.
+Parameters:
+    geometryData    Self-explanatory.
+    extentCellX     The bounding box's width in EXTENT_CELL_SIZE steps.
+    extentCellY     Same for the height.
+Returns:
+    Self-explanatory.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static unsigned long long ShapeKey(const GeometryData &geometryData, long long extentCellX,
+    long long extentCellY)
+{
+    unsigned long long key[5] =
+    {
+        geometryData._drawStyle,
+        geometryData._verts.size(),
+        GeometryCache::HashBytes(reinterpret_cast<const char *>(geometryData._indices.data()),
+            geometryData._indices.size() * sizeof(unsigned int)),
+        static_cast<unsigned long long>(extentCellX),
+        static_cast<unsigned long long>(extentCellY),
+    };
+    return GeometryCache::HashBytes(reinterpret_cast<const char *>(key), sizeof(key));
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Self-explanatory.
+Parameters:
+    left    Self-explanatory.
+    right   Self-explanatory.
+Returns:
+    True if the two are within TRANSLATED_COPY_TOLERANCE of each other, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static bool NearlyEqual(float left, float right)
+{
+    return fabsf(left - right) <= TRANSLATED_COPY_TOLERANCE;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Checks whether one object is another one moved, and nothing else.  This is the exact
+    check that the hash only narrows down.
+Parameters:
+    copy            Self-explanatory.
+    copyCentroid    From Centroid(...).
+    original        Self-explanatory.
+    originalCentroid    From Centroid(...).
+Returns:
+    True if every vertex of the copy, relative to its centroid, is the original's (within
+    TRANSLATED_COPY_TOLERANCE) and the two are drawn the same way, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static bool IsTranslatedCopy(const GeometryData &copy, const glm::vec2 &copyCentroid,
+    const GeometryData &original, const glm::vec2 &originalCentroid)
+{
+    if (copy._drawStyle != original._drawStyle ||
+        copy._indexType != original._indexType ||
+        copy._verts.size() != original._verts.size() ||
+        copy._indices != original._indices)
+    {
+        return false;
+    }
+
+    for (size_t vertIndex = 0; vertIndex < copy._verts.size(); vertIndex++)
+    {
+        const MyVertex &copyVert = copy._verts[vertIndex];
+        const MyVertex &originalVert = original._verts[vertIndex];
+        if (!NearlyEqual(copyVert._position.x - copyCentroid.x,
+            originalVert._position.x - originalCentroid.x) ||
+            !NearlyEqual(copyVert._position.y - copyCentroid.y,
+            originalVert._position.y - originalCentroid.y) ||
+            !NearlyEqual(copyVert._position.z, originalVert._position.z) ||
+            !NearlyEqual(copyVert._position.w, originalVert._position.w) ||
+            !NearlyEqual(copyVert._normal.x, originalVert._normal.x) ||
+            !NearlyEqual(copyVert._normal.y, originalVert._normal.y) ||
+            !NearlyEqual(copyVert._normal.z, originalVert._normal.z))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Ensures that the finder starts out without any originals.
+Parameters: None
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+TranslatedCopyFinder::TranslatedCopyFinder() :
+    _numCopies(0),
+    _numVertsDropped(0)
+{
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Looks for an earlier original that the object is a copy of.  If there is one, the object
+    becomes an instance of it: its vertices and indices are thrown out, and _instanceOf and
+    _instanceOffset are set.  Otherwise it becomes an original itself.
+
+    Note: A copy's bounding box can be up to twice the tolerance bigger or smaller than its
+    original's, which can put it in the next cell over, so the cells on either side are
+    checked too if the size is that close to a cell's edge.
+Parameters:
+    geometry    The scene.  Every object that was already processed must still be in it,
+                unchanged.
+    handle      The object.  Call once per object, in order.
+Returns:
+    True if the object became an instance, otherwise false.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+bool TranslatedCopyFinder::Process(GeometryRegistry *geometry, GeometryRegistry::HANDLE handle)
+{
+    GeometryData &geometryData = geometry->Geometry(handle);
+    if (geometryData._verts.empty())
+    {
+        return false;
+    }
+
+    glm::vec2 centroid = Centroid(geometryData._verts);
+    glm::vec2 extent = Extent(geometryData._verts);
+    float slack = 2.0f * TRANSLATED_COPY_TOLERANCE;
+    long long lowCellX = static_cast<long long>(floorf((extent.x - slack) / EXTENT_CELL_SIZE));
+    long long highCellX = static_cast<long long>(floorf((extent.x + slack) / EXTENT_CELL_SIZE));
+    long long lowCellY = static_cast<long long>(floorf((extent.y - slack) / EXTENT_CELL_SIZE));
+    long long highCellY = static_cast<long long>(floorf((extent.y + slack) / EXTENT_CELL_SIZE));
+    for (long long cellX = lowCellX; cellX <= highCellX; cellX++)
+    {
+        for (long long cellY = lowCellY; cellY <= highCellY; cellY++)
+        {
+            auto itr = _originalsByKey.find(ShapeKey(geometryData, cellX, cellY));
+            if (itr == _originalsByKey.end())
+            {
+                continue;
+            }
+
+            const std::vector<Original> &candidates = itr->second;
+            for (size_t candidateIndex = 0; candidateIndex < candidates.size(); candidateIndex++)
+            {
+                const Original &original = candidates[candidateIndex];
+                if (!IsTranslatedCopy(geometryData, centroid,
+                    geometry->Geometry(original._handle), original._centroid))
+                {
+                    continue;
+                }
+
+                _numCopies++;
+                _numVertsDropped += geometryData._verts.size();
+                geometryData._instanceOf = original._handle;
+                geometryData._instanceOffset = centroid - original._centroid;
+
+                // give the memory back; clear() alone would keep it
+                std::vector<MyVertex>().swap(geometryData._verts);
+                std::vector<unsigned int>().swap(geometryData._indices);
+                return true;
+            }
+        }
+    }
+
+    long long cellX = static_cast<long long>(floorf(extent.x / EXTENT_CELL_SIZE));
+    long long cellY = static_cast<long long>(floorf(extent.y / EXTENT_CELL_SIZE));
+    Original original = { handle, centroid };
+    _originalsByKey[ShapeKey(geometryData, cellX, cellY)].push_back(original);
+    return false;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Self-explanatory.
+Parameters: None
+Returns:
+    The number of objects that became instances.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+size_t TranslatedCopyFinder::NumCopies() const
+{
+    return _numCopies;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Self-explanatory.
+Parameters: None
+Returns:
+    The number of vertices that the instances threw out.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+size_t TranslatedCopyFinder::NumVertsDropped() const
+{
+    return _numVertsDropped;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Runs a TranslatedCopyFinder over every object, in order.  For the output of
+    BlenderLoad::LoadObj(...) and the like, once it is in its final collection.
+
+    Note: The instances refer to their originals by handle, so the objects must not be moved
+    into another collection afterwards.
+Parameters:
+    geometry    Self-explanatory.
+Returns:
+    The number of objects that became instances.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+size_t InstanceTranslatedCopies(GeometryRegistry *geometry)
+{
+    TranslatedCopyFinder finder;
+    for (GeometryRegistry::HANDLE handle = 0; handle < geometry->Size(); handle++)
+    {
+        finder.Process(geometry, handle);
+    }
+    return finder.NumCopies();
+}
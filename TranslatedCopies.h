@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stddef.h>
+#include <unordered_map>
+#include <vector>
+#include "glm/vec2.hpp"
+
+#include "GeometryRegistry.h"
+
+// how far apart (in window space) a copy's vertex may be from the original's, once the two are
+// lined up, and still count as the same
+// Note: The .obj text has 6 decimal places, so two copies of the same shape can differ by a
+// couple of millionths after rounding.  This is still well under a pixel.
+constexpr float TRANSLATED_COPY_TOLERANCE = 0.00001f;
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Finds objects that are the same shape as an earlier object, just somewhere else, and turns
+    them into instances of it (see GeometryData::_instanceOf).  A copy gives up its vertices
+    and indices, and the original's are drawn again, moved by the copy's offset.  A grid of
+    the same few shapes then takes only a few meshes' worth of memory and draw commands.
+
+    Two objects are compared by their vertices relative to their centroids.  A hash of what
+    can't vary between copies (draw style, vertex count, indices, and the size of the bounding
+    box, rounded to cells) narrows the search down to a few candidates.  The candidates are
+    then compared vertex by vertex within TRANSLATED_COPY_TOLERANCE.
+
+    Note: Objects are processed in order, and the first of each shape becomes the original, so
+    an original always comes before its copies.  Instances are never originals.
+-----------------------------------------------------------------------------------------------*/
+class TranslatedCopyFinder
+{
+public:
+    TranslatedCopyFinder();
+
+    bool Process(GeometryRegistry *geometry, GeometryRegistry::HANDLE handle);
+    size_t NumCopies() const;
+    size_t NumVertsDropped() const;
+
+private:
+    /*-------------------------------------------------------------------------------------------
+    Description:
+        An object that copies may be instances of.  The centroid is kept so that it doesn't
+        have to be worked out again for every comparison.
+    -------------------------------------------------------------------------------------------*/
+    struct Original
+    {
+        GeometryRegistry::HANDLE _handle;
+        glm::vec2 _centroid;
+    };
+
+    std::unordered_map<unsigned long long, std::vector<Original>> _originalsByKey;
+    size_t _numCopies;
+    size_t _numVertsDropped;
+};
+
+size_t InstanceTranslatedCopies(GeometryRegistry *geometry);
@@ -0,0 +1,177 @@
+#include "VertexLayout.h"
+
+#include <math.h>
+#include "glm/gtc/packing.hpp"
+
+// the tables are handed to OpenGL by address, so they need a definition somewhere
+constexpr VertexAttribute Vertex2DPackedNormal::ATTRIBUTES[];
+constexpr VertexAttribute Vertex2D::ATTRIBUTES[];
+constexpr VertexAttribute Vertex2DQuantized::ATTRIBUTES[];
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Ensures that the quantization starts out as the one that changes nothing.
+Parameters: None
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+PositionQuantization::PositionQuantization() :
+    _offset(0.0f, 0.0f),
+    _scale(1.0f, 1.0f)
+{
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Works out the quantization that spreads a quantized layout's range over the vertices'
+    bounding box, so that the bits go where the object actually is.
+Parameters:
+    verts   Self-explanatory.
+Returns:
+    The offset is the bounding box's minimum corner and the scale is its size.  A flat box
+    (every vertex with the same X, say) gets a scale of 0 along that axis, which is exact.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+PositionQuantization PositionQuantizationForBounds(const std::vector<MyVertex> &verts)
+{
+    PositionQuantization quantization;
+    if (verts.empty())
+    {
+        return quantization;
+    }
+
+    glm::vec2 boundsMin(verts[0]._position.x, verts[0]._position.y);
+    glm::vec2 boundsMax = boundsMin;
+    for (size_t vertIndex = 1; vertIndex < verts.size(); vertIndex++)
+    {
+        const glm::vec4 &position = verts[vertIndex]._position;
+        boundsMin.x = (position.x < boundsMin.x) ? position.x : boundsMin.x;
+        boundsMin.y = (position.y < boundsMin.y) ? position.y : boundsMin.y;
+        boundsMax.x = (position.x > boundsMax.x) ? position.x : boundsMax.x;
+        boundsMax.y = (position.y > boundsMax.y) ? position.y : boundsMax.y;
+    }
+
+    quantization._offset = boundsMin;
+    quantization._scale = boundsMax - boundsMin;
+    return quantization;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    The inverse of what OpenGL does with a normalized unsigned 16-bit vertex component.
+Parameters:
+    value   Clamped to [0, 1].
+Returns:
+    The nearest 16-bit integer to value * 65535.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static unsigned short PackUnorm16(float value)
+{
+    float clamped = (value < 0.0f) ? 0.0f : ((value > 1.0f) ? 1.0f : value);
+    return static_cast<unsigned short>(floorf((clamped * 65535.0f) + 0.5f));
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Puts one position component into [0, 1] within its axis of the bounding box.
+Parameters:
+    value   Self-explanatory.
+    offset  The bounding box's minimum along this axis.
+    scale   The bounding box's size along this axis.
+Returns:
+    The position within the box, or 0 if the box is flat along this axis.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static float NormalizeToBounds(float value, float offset, float scale)
+{
+    return (scale > 0.0f) ? ((value - offset) / scale) : 0.0f;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    The inverse of what OpenGL does with a normalized signed 16-bit vertex component.
+Parameters:
+    value   Clamped to [-1, 1].
+Returns:
+    The nearest 16-bit integer to value * 32767.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static short PackSnorm16(float value)
+{
+    float clamped = (value < -1.0f) ? -1.0f : ((value > 1.0f) ? 1.0f : value);
+    return static_cast<short>(floorf((clamped * 32767.0f) + 0.5f));
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Drops the Z and W that MyVertex carries around and packs the normal.
+Parameters:
+    vertex  From the loader.
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+Vertex2DPackedNormal::Vertex2DPackedNormal(const MyVertex &vertex,
+    const PositionQuantization &) :
+    _position(vertex._position.x, vertex._position.y)
+{
+    _normal[0] = PackSnorm16(vertex._normal.x);
+    _normal[1] = PackSnorm16(vertex._normal.y);
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Keeps the position's X and Y.  Everything else is dropped.
+Parameters:
+    vertex  From the loader.
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+Vertex2D::Vertex2D(const MyVertex &vertex, const PositionQuantization &) :
+    _position(vertex._position.x, vertex._position.y)
+{
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Squeezes the position into the object's bounding box and packs the normal.
+Parameters:
+    vertex          From the loader.
+    quantization    From PositionQuantizationForBounds(...) on the vertex's object.
+Returns:    None
+-----------------------------------------------------------------------------------------------*/
+Vertex2DQuantized::Vertex2DQuantized(const MyVertex &vertex,
+    const PositionQuantization &quantization)
+{
+    _position[0] = PackUnorm16(NormalizeToBounds(vertex._position.x, quantization._offset.x,
+        quantization._scale.x));
+    _position[1] = PackUnorm16(NormalizeToBounds(vertex._position.y, quantization._offset.y,
+        quantization._scale.y));
+    _normal = glm::packSnorm3x10_1x2(glm::vec4(vertex._normal.x, vertex._normal.y, 0.0f, 0.0f));
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Does what OpenGL and the vertex shader do to the stored position.  For measuring the
+    quantization error.
+Parameters:
+    quantization    The one that the vertex was made with.
+Returns:
+    The position that will be drawn.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+glm::vec2 Vertex2DQuantized::Position(const PositionQuantization &quantization) const
+{
+    glm::vec2 normalized(_position[0] / 65535.0f, _position[1] / 65535.0f);
+    return quantization._offset + (normalized * quantization._scale);
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Does what OpenGL does to the stored normal.  For measuring the quantization error.
+Parameters: None
+Returns:
+    The normal's X and Y as the vertex shader will see them.
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+glm::vec2 Vertex2DQuantized::Normal() const
+{
+    glm::vec4 normal = glm::unpackSnorm3x10_1x2(_normal);
+    return glm::vec2(normal.x, normal.y);
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+#include "glm/vec2.hpp"
+
+#include "MyVertex.h"
+
+// the values of GL_SHORT, GL_UNSIGNED_SHORT, GL_FLOAT, and GL_INT_2_10_10_10_REV
+// Note: Written out so that the layouts (and GeometryData.h) don't have to include OpenGL.
+// SharedGeometryBuffer.cpp checks them against the real ones.
+const unsigned int VERTEX_COMPONENT_SHORT = 0x1402;
+const unsigned int VERTEX_COMPONENT_UNSIGNED_SHORT = 0x1403;
+const unsigned int VERTEX_COMPONENT_FLOAT = 0x1406;
+const unsigned int VERTEX_COMPONENT_INT_2_10_10_10_REV = 0x8D9F;
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Everything that glVertexAttribPointer(...) needs to know about one vertex attribute (one
+    "in" variable in the vertex shader), minus the stride, which is the size of the vertex.
+-----------------------------------------------------------------------------------------------*/
+struct VertexAttribute
+{
+    unsigned int _location;         // "layout (location = ?)" in the shader
+    unsigned int _numComponents;    // 1 - 4
+    unsigned int _componentType;    // VERTEX_COMPONENT_*
+    bool _normalized;               // integer components are mapped to [-1, 1] if true
+    unsigned int _offsetBytes;      // from the start of the vertex
+};
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    How to get from a stored position to the real one: real = _offset + (stored * _scale).  The
+    vertex shader does this with its "positionDequantization" input (see SceneDrawList).
+
+    Note: Layouts that store full floats use the default (offset 0, scale 1), which changes
+    nothing.
+-----------------------------------------------------------------------------------------------*/
+struct PositionQuantization
+{
+    PositionQuantization();
+
+    glm::vec2 _offset;
+    glm::vec2 _scale;
+};
+
+PositionQuantization PositionQuantizationForBounds(const std::vector<MyVertex> &verts);
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    A compact vertex for filled 2D shapes: an XY position and an XY normal packed into two
+    normalized 16-bit integers.  12 bytes instead of MyVertex's 32.
+
+    A vertex layout is any struct with:
+    - a constructor that takes a MyVertex (what the loader produces) and the object's
+      PositionQuantization
+    - QUANTIZED_POSITIONS, which says whether that PositionQuantization is used
+    - NUM_ATTRIBUTES and ATTRIBUTES, which describe it to OpenGL
+    See SharedGeometryBuffer::InitWithLayout(...).
+
+    Note: The shader's "in vec4 pos" gets z = 0 and w = 1 filled in by OpenGL for a 2-component
+    attribute, which is what MyVertex stored explicitly.
+-----------------------------------------------------------------------------------------------*/
+struct Vertex2DPackedNormal
+{
+    Vertex2DPackedNormal(const MyVertex &vertex, const PositionQuantization &);
+
+    glm::vec2 _position;
+
+    // X and Y, with [-1, 1] mapped to [-32767, 32767]
+    short _normal[2];
+
+    static constexpr bool QUANTIZED_POSITIONS = false;
+    static constexpr unsigned int NUM_ATTRIBUTES = 2;
+    static constexpr VertexAttribute ATTRIBUTES[NUM_ATTRIBUTES] =
+    {
+        { 0, 2, VERTEX_COMPONENT_FLOAT, false, 0 },
+        { 1, 2, VERTEX_COMPONENT_SHORT, true, sizeof(glm::vec2) },
+    };
+};
+static_assert(sizeof(Vertex2DPackedNormal) == 12, "Vertex2DPackedNormal is not tightly packed");
+static_assert(offsetof(Vertex2DPackedNormal, _normal) == sizeof(glm::vec2),
+    "Vertex2DPackedNormal's attribute offsets are wrong");
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    An XY position and nothing else.  Lines don't use their normals, so there is no reason to
+    upload them.  8 bytes instead of MyVertex's 32.
+-----------------------------------------------------------------------------------------------*/
+struct Vertex2D
+{
+    Vertex2D(const MyVertex &vertex, const PositionQuantization &);
+
+    glm::vec2 _position;
+
+    static constexpr bool QUANTIZED_POSITIONS = false;
+    static constexpr unsigned int NUM_ATTRIBUTES = 1;
+    static constexpr VertexAttribute ATTRIBUTES[NUM_ATTRIBUTES] =
+    {
+        { 0, 2, VERTEX_COMPONENT_FLOAT, false, 0 },
+    };
+};
+static_assert(sizeof(Vertex2D) == 8, "Vertex2D is not tightly packed");
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    The smallest layout: the position as two normalized 16-bit integers that span the object's
+    bounds (see PositionQuantization), and the normal packed into 10 bits per component.
+    8 bytes instead of MyVertex's 32.
+
+    Note: The shapes all sit inside [-1, 1], so even an object that fills the whole window is
+    off by at most ~0.000015 (1/65535), well under a pixel.  Smaller objects do better.  See
+    BlenderLoad::LoadOptions::_quantizeVertices for measuring it.
+-----------------------------------------------------------------------------------------------*/
+struct Vertex2DQuantized
+{
+    Vertex2DQuantized(const MyVertex &vertex, const PositionQuantization &quantization);
+    glm::vec2 Position(const PositionQuantization &quantization) const;
+    glm::vec2 Normal() const;
+
+    // X and Y, with the object's bounds mapped to [0, 65535]
+    unsigned short _position[2];
+
+    // X, Y, and Z (always 0) in 10 bits each, X in the lowest bits (see
+    // glm::packSnorm3x10_1x2(...))
+    unsigned int _normal;
+
+    static constexpr bool QUANTIZED_POSITIONS = true;
+    static constexpr unsigned int NUM_ATTRIBUTES = 2;
+    static constexpr VertexAttribute ATTRIBUTES[NUM_ATTRIBUTES] =
+    {
+        { 0, 2, VERTEX_COMPONENT_UNSIGNED_SHORT, true, 0 },
+
+        // a packed format always has 4 components
+        { 1, 4, VERTEX_COMPONENT_INT_2_10_10_10_REV, true, 2 * sizeof(unsigned short) },
+    };
+};
+static_assert(sizeof(Vertex2DQuantized) == 8, "Vertex2DQuantized is not tightly packed");
+static_assert(offsetof(Vertex2DQuantized, _normal) == 2 * sizeof(unsigned short),
+    "Vertex2DQuantized's attribute offsets are wrong");
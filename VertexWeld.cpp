@@ -0,0 +1,101 @@
+#include "VertexWeld.h"
+
+// for memcpy(...) and memcmp(...)
+#include <string.h>
+
+// marks an empty slot in the hash table
+static const unsigned int EMPTY_SLOT = 0xFFFFFFFF;
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Hashes the raw bits of a vertex.  Equal vertices must hash the same, and since vertices
+    are compared with memcmp(...), bits are what matter (so 0.0 and -0.0 are different).
+Parameters:
+    vertex  Self-explanatory.
+Returns:
+    A 32-bit hash that is well mixed in the low bits (the table is indexed by them).
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+static unsigned int HashVertex(const MyVertex &vertex)
+{
+    unsigned int words[sizeof(MyVertex) / sizeof(unsigned int)];
+    memcpy(words, &vertex, sizeof(words));
+
+    // FNV-1a over 32-bit words, then a final avalanche (from MurmurHash3's fmix32) because
+    // FNV leaves the low bits weak
+    unsigned int hash = 2166136261u;
+    for (size_t wordIndex = 0; wordIndex < sizeof(words) / sizeof(words[0]); wordIndex++)
+    {
+        hash = (hash ^ words[wordIndex]) * 16777619u;
+    }
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Welds identical vertices.  See the header.
+
+    Note: This uses an open-addressing hash table of indices into the unique vertices rather
+    than a std::unordered_map<MyVertex, ...>.  There is one flat allocation, no per-node
+    allocations, and the vertices themselves are only stored once.
+
+    Also Note: The unique vertices keep the order in which they first show up, so the result
+    does not depend on the hash.
+Parameters:
+    verts           In: the expanded vertices.  Out: only the unique ones.
+    putIndicesHere  Cleared, then gets one index per original vertex.
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+void WeldVertices(std::vector<MyVertex> *verts, std::vector<unsigned int> *putIndicesHere)
+{
+    size_t numVerts = verts->size();
+    putIndicesHere->resize(numVerts);
+
+    // power of 2, and at most half full even if nothing is welded
+    size_t tableSize = 16;
+    while (tableSize < numVerts * 2)
+    {
+        tableSize *= 2;
+    }
+    size_t tableMask = tableSize - 1;
+    std::vector<unsigned int> table(tableSize, EMPTY_SLOT);
+
+    // unique vertices are compacted to the front of the same array as they are found, which is
+    // safe because the write position never passes the read position
+    MyVertex *vertData = verts->data();
+    unsigned int numUniqueVerts = 0;
+    for (size_t vertIndex = 0; vertIndex < numVerts; vertIndex++)
+    {
+        const MyVertex &vertex = vertData[vertIndex];
+        size_t slot = HashVertex(vertex) & tableMask;
+        while (true)
+        {
+            unsigned int uniqueIndex = table[slot];
+            if (uniqueIndex == EMPTY_SLOT)
+            {
+                table[slot] = numUniqueVerts;
+                vertData[numUniqueVerts] = vertex;
+                (*putIndicesHere)[vertIndex] = numUniqueVerts;
+                numUniqueVerts++;
+                break;
+            }
+            else if (memcmp(&vertData[uniqueIndex], &vertex, sizeof(MyVertex)) == 0)
+            {
+                (*putIndicesHere)[vertIndex] = uniqueIndex;
+                break;
+            }
+
+            // linear probing
+            slot = (slot + 1) & tableMask;
+        }
+    }
+
+    verts->resize(numUniqueVerts);
+    verts->shrink_to_fit();
+}
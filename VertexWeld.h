@@ -0,0 +1,18 @@
+#pragma once
+
+#include <vector>
+#include "MyVertex.h"
+
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Collapses vertices that are exactly the same (every bit of the position and the normal)
+    into one, and produces the indices that rebuild the original vertex order.  Drawing the
+    result with glDrawElements(...) gives the same picture as drawing the original vertices
+    with glDrawArrays(...).
+
+    Note: Blender writes each quad as 4 corners that refer to shared positions, and the loader
+    expands every quad into 2 triangles (6 vertices), so the corners inside a filled shape are
+    duplicated once for each triangle that touches them.  Welding gets rid of those copies.
+-----------------------------------------------------------------------------------------------*/
+
+void WeldVertices(std::vector<MyVertex> *verts, std::vector<unsigned int> *putIndicesHere);
@@ -33,14 +33,17 @@
 // for printf(...)
 #include <stdio.h>
 
+// for sorting the scene's files by load time
+#include <algorithm>
+
 #include "OpenGlErrorHandling.h"
 #include "GenerateShader.h"
 #include "GeometryData.h"
+#include "SharedGeometryBuffer.h"
+#include "SceneDrawList.h"
+#include "ObjectTransformBuffer.h"
 #include "BlenderLoad.h"
-
-// for moving the shapes around in window space
-#include "glm/gtc/matrix_transform.hpp"
-#include "glm/gtc/type_ptr.hpp"
+#include "AsyncSceneLoader.h"
 
 // in a bigger program, this would be stored in some kind of shader storage
 GLuint gProgramId;
@@ -49,9 +52,30 @@ GLuint gProgramId;
 // or behind door number 3 so that collision boxes could get at the vertex data
 BlenderLoad::GEOMETRY_DATA_BY_NAME gGeometryStorage;
 
-// in a bigger program, uniform locations would probably be stored in the same place as the 
-// shader programs
-GLint gUniformLocation;
+// every object's vertices and indices are uploaded into this, so the whole scene is drawn with
+// one vertex array object
+SharedGeometryBuffer gGeometryBuffer;
+
+// draws the whole scene with a few multi-draw calls; rebuilt whenever objects are added
+SceneDrawList gSceneDrawList;
+
+// for moving the shapes around in window space, one transform per object (identity unless
+// something moves them)
+ObjectTransformBuffer gObjectTransforms;
+
+// false if gObjectTransforms couldn't be made, in which case the scene isn't loaded or drawn
+bool gTransformsAvailable = false;
+
+// loads the scene in the background while the window is already up (see Display())
+// Note: Either a single .obj file or a scene manifest (see SceneManifest).  Can be replaced on
+// the command line.
+std::string gScenePath = "BlenderStuff/circle_square_grid.obj";
+AsyncSceneLoader gSceneLoader;
+bool gSceneLoadReported = false;
+
+// how much of each frame may be spent uploading newly loaded objects
+// Note: ~4ms out of the ~16.7ms of a 60Hz frame.
+const double SCENE_UPLOAD_BUDGET_SECONDS = 0.004;
 
 
 
@@ -79,21 +103,112 @@ void Init()
     glDepthFunc(GL_LEQUAL);
     glDepthRange(0.0f, 1.0f);
 
+    // stitched outlines (see LineStitch.h) separate their strips with the all-ones index
+    glEnable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
+
     gProgramId = GenerateShaderProgram();
-    gUniformLocation = glGetUniformLocation(gProgramId, "translateMatrixWindowSpace");
+    gTransformsAvailable = gObjectTransforms.Init();
+    if (!gTransformsAvailable)
+    {
+        // the vertex shader reads every object's transform, so nothing can be drawn
+        printf("Objects can't be drawn without their transforms; the scene won't be loaded\n");
+        return;
+    }
+
+    // the objects are uploaded and added to gGeometryStorage as they show up (see Display())
+    BlenderLoad::LoadOptions loadOptions;
+    loadOptions._weldVertices = true;
+    loadOptions._quantizeVertices = true;
+    loadOptions._stitchLines = true;
+    loadOptions._instanceCopies = true;
+    gGeometryBuffer.Init(loadOptions._quantizeVertices);
+    gSceneDrawList.Init(gGeometryBuffer);
+    gSceneLoader.Start(gScenePath, loadOptions);
+
+    printf("");
+}
 
-    if (!BlenderLoad::LoadObj("BlenderStuff/circle_square_grid.obj", &gGeometryStorage))
+/*-----------------------------------------------------------------------------------------------
+Description:
+    Prints the loader's statistics once the background load (see Init()) is done.
+Parameters: None
+Returns:    None
+Exception:  Safe
+-----------------------------------------------------------------------------------------------*/
+void ReportSceneLoad()
+{
+    if (!gSceneLoader.Succeeded())
     {
         printf("Geometry loading failed\n");
-        //??return??
     }
 
-    for (auto itr = gGeometryStorage.begin(); itr != gGeometryStorage.end(); itr++)
+    const BlenderLoad::LoadStatistics &loadStats = gSceneLoader.Statistics();
+    if (loadStats._loadedFromCache)
+    {
+        printf("Loaded from the binary cache in %.3f seconds, peak memory %.1f MB\n",
+            loadStats._parseSeconds, loadStats._peakResidentBytes / (1024.0 * 1024.0));
+    }
+    else
+    {
+        printf("Parsed %llu bytes (%llu lines) in %.3f seconds (%.2f MB/s), peak memory "
+            "%.1f MB\n", loadStats._bytesParsed, loadStats._lineCounts.Total(),
+            loadStats._parseSeconds, loadStats.MegabytesPerSecond(),
+            loadStats._peakResidentBytes / (1024.0 * 1024.0));
+    }
+    for (size_t objectIndex = 0; objectIndex < loadStats._weldStats.size(); objectIndex++)
     {
-        itr->second.Init(gProgramId);
+        const BlenderLoad::WeldStatistics &weldStats = loadStats._weldStats[objectIndex];
+        printf("    %s: welded %u vertices into %u (%u bytes -> %u bytes)\n",
+            weldStats._objectName.c_str(), static_cast<unsigned int>(weldStats._vertsBefore),
+            static_cast<unsigned int>(weldStats._vertsAfter),
+            static_cast<unsigned int>(weldStats._bytesBefore),
+            static_cast<unsigned int>(weldStats._bytesAfter));
     }
 
-    printf("");
+    // only the worst one; every object is well under a pixel unless something is wrong
+    const BlenderLoad::QuantizationStatistics *worstQuantization = 0;
+    for (size_t objectIndex = 0; objectIndex < loadStats._quantizationStats.size();
+        objectIndex++)
+    {
+        const BlenderLoad::QuantizationStatistics &quantizationStats =
+            loadStats._quantizationStats[objectIndex];
+        if (worstQuantization == 0 ||
+            quantizationStats._maxPositionError > worstQuantization->_maxPositionError)
+        {
+            worstQuantization = &quantizationStats;
+        }
+    }
+    if (worstQuantization != 0)
+    {
+        printf("    quantization: worst position error %g (%s), normal error %g\n",
+            worstQuantization->_maxPositionError, worstQuantization->_objectName.c_str(),
+            worstQuantization->_maxNormalError);
+    }
+    printf("    drawing %u objects (%u meshes) with %u multi-draw calls\n",
+        static_cast<unsigned int>(gSceneDrawList.NumInstances()),
+        static_cast<unsigned int>(gSceneDrawList.NumCommands()),
+        static_cast<unsigned int>(gSceneDrawList.NumMultiDrawCalls()));
+
+    // if the GPU falls behind by more frames than the ring has regions, this shows it
+    const PersistentRingBuffer &transformRing = gObjectTransforms.Ring();
+    printf("    transforms: %llu uploads, blocked on %llu fences for %.3f ms\n",
+        transformRing.NumRegionsBegun(), transformRing.NumFenceWaits(),
+        transformRing.FenceWaitSeconds() * 1000.0);
+
+    // slowest first, since those are the ones worth looking at
+    std::vector<SceneManifest::FileStatistics> fileStats = gSceneLoader.SceneFileStatistics();
+    std::sort(fileStats.begin(), fileStats.end(),
+        [](const SceneManifest::FileStatistics &left, const SceneManifest::FileStatistics &right)
+    {
+        return left._stats._parseSeconds > right._stats._parseSeconds;
+    });
+    for (size_t fileIndex = 0; fileIndex < fileStats.size(); fileIndex++)
+    {
+        const SceneManifest::FileStatistics &stats = fileStats[fileIndex];
+        printf("    %.3f seconds: %s (%u objects, %.2f MB/s)%s\n", stats._stats._parseSeconds,
+            stats._filePath.c_str(), static_cast<unsigned int>(stats._numObjects),
+            stats._stats.MegabytesPerSecond(), stats._succeeded ? "" : " FAILED");
+    }
 }
 
 /*-----------------------------------------------------------------------------------------------
@@ -114,18 +229,34 @@ void Display()
     glClearDepth(1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+    // pick up whatever the background loader has finished since the last frame
+    if (gTransformsAvailable && !gSceneLoadReported)
+    {
+        size_t numUploaded = gSceneLoader.UploadPending(&gGeometryBuffer,
+            SCENE_UPLOAD_BUDGET_SECONDS, &gGeometryStorage);
+        if (numUploaded > 0)
+        {
+            gSceneDrawList.Build(gGeometryStorage);
+            gObjectTransforms.Resize(gGeometryStorage.Size());
+        }
+        if (gSceneLoader.IsFinished())
+        {
+            ReportSceneLoad();
+            gSceneLoadReported = true;
+        }
+    }
+
     glUseProgram(gProgramId);
 
-    // vertices from the Blender OBJ file are already in world space, so don't touch them with a 
-    // transformation, but the vertex shader still needs a transform, so give it the identity 
-    // matrix
-    glm::mat4 translateMatrix;
-    glUniformMatrix4fv(gUniformLocation, 1, GL_FALSE, glm::value_ptr(translateMatrix));
-    for (auto itr = gGeometryStorage.begin(); itr != gGeometryStorage.end(); itr++)
+    // vertices from the Blender OBJ file are already in window space, so the transforms are
+    // the identity until something moves an object, in which case this is the one write of
+    // the frame
+    // Note: If the transforms couldn't be written, the shader would read a stale (or deleted)
+    // buffer, so the scene is skipped for this frame.
+    if (gTransformsAvailable && gObjectTransforms.Upload())
     {
-        const GeometryData &geoRef = itr->second;
-        glBindVertexArray(geoRef._vaoId);
-        glDrawArrays(geoRef._drawStyle, 0, geoRef._verts.size());
+        gSceneDrawList.Draw();
+        gObjectTransforms.EndFrame();
     }
 
     // cleanup
@@ -240,6 +371,12 @@ int main(int argc, char *argv[])
 {
     glutInit(&argc, argv);
 
+    // glutInit(...) takes out the arguments that it knows, so whatever is left is ours
+    if (argc > 1)
+    {
+        gScenePath = argv[1];
+    }
+
     int width = 500;
     int height = 500;
     unsigned int displayMode = GLUT_DOUBLE | GLUT_ALPHA | GLUT_DEPTH | GLUT_STENCIL;
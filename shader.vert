@@ -2,7 +2,34 @@
 
 layout (location = 0) in vec4 pos;
 
-uniform mat4 translateMatrixWindowSpace;
+// moves, rotates, and scales one object in window space: (linear * pos) + translation, where
+// linear is a 2x2 matrix stored by columns (xy, zw)
+// Note: Must match ObjectTransform2D in ObjectTransformBuffer.h.
+struct ObjectTransform
+{
+    vec4 linear;
+    vec2 translation;
+};
+
+// one per object in the scene, indexed by the object's handle (see ObjectTransformBuffer)
+layout (std430, binding = 0) readonly buffer ObjectTransforms
+{
+    ObjectTransform objectTransforms[];
+};
+
+// xy: offset, zw: scale; the real position is offset + (pos * scale)
+// Note: (0, 0, 1, 1) unless the object was uploaded with quantized positions (see
+// PositionQuantization in VertexLayout.h).
+// Also Note: One per object rather than a uniform, since a whole group of objects is drawn at
+// once (see SceneDrawList).
+layout (location = 2) in vec4 positionDequantization;
+
+// where a translated copy is relative to the object whose vertices it shares; (0, 0) for the
+// object itself (see TranslatedCopies.h)
+layout (location = 3) in vec2 instanceOffset;
+
+// which of objectTransforms to use; a translated copy has its own
+layout (location = 4) in uint objectIndex;
 
 // must have the same name as its corresponding "in" item in the frag shader
 smooth out vec3 vertOutColor;
@@ -12,6 +39,11 @@ void main()
     // no colors from the Blender OBJ files; just hard-code white
     vertOutColor = vec3(1.0f, 1.0f, 1.0f);
 
-	gl_Position = translateMatrixWindowSpace * pos;
+    vec2 dequantizedPos = positionDequantization.xy + (pos.xy * positionDequantization.zw);
+    vec2 windowPos = dequantizedPos + instanceOffset;
+
+    ObjectTransform objectTransform = objectTransforms[objectIndex];
+    mat2 linear = mat2(objectTransform.linear.xy, objectTransform.linear.zw);
+	gl_Position = vec4((linear * windowPos) + objectTransform.translation, pos.zw);
 }
 